@@ -0,0 +1,637 @@
+///
+/// \brief Замеры горячих путей библиотеки на simulate-бэкенде.
+/// \details Результаты выводятся в формате JSON (stdout или --output), чтобы их можно было
+/// сравнивать между сборками. Каждый замер - name, iterations, ns_per_op, ops_per_sec и
+/// дополнительные метрики (bytes_per_sec, задержки и т.п.).
+///
+/// Параметры:
+///   --boards N        число simulate-носителей (по умолчанию 2)
+///   --iterations N    число итераций коротких замеров (по умолчанию 100000)
+///   --filter STR      выполнять только замеры, имя которых содержит STR
+///   --output FILE     файл результатов вместо stdout
+///   --record-dir DIR  каталог для замера stream_recorder (по умолчанию /dev/shm)
+///   --verbose         выводить каждый результат в stderr по мере замера
+///
+/// Сборка: вместе со всеми исходниками полной библиотеки (io, config_parser, logger, юниты,
+/// микросхемы и подсистемы, которых нет в этом фрагменте), пути include - каталоги include
+/// и lib библиотеки, C++17, -pthread; список внешних заголовков - в README.md.
+/// Для замера счетчиков обращений к регистрам добавить -DNEBULAXI_REG_STATS.
+///
+/// Сравнение кода axi_reg::set/get с ручной работой с масками: функции bench_axi_*
+/// и bench_manual_* объявлены noinline, их код можно сравнить через objdump -d.
+///
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#include "nebulaxi/carrier.hpp"
+#include "nebulaxi/data_storage.hpp"
+#include "nebulaxi/resource_manager.hpp"
+#include "nebulaxi/stream_group.hpp"
+#include "nebulaxi/stream_recorder.hpp"
+#include "nebulaxi/subsystems/dma_ring.hpp"
+#include "nebulaxi/subsystems/icr_carrier.hpp"
+#include "nebulaxi/subsystems/sdram_stream.hpp"
+#include "nebulaxi/units/reg.hpp"
+#include "nebulaxi/units/sysmon.hpp"
+
+#include "carrier_builder.hxx"
+#include "carrier_config.hxx"
+#include "io/io.hxx"
+#include "subsystems/dma_engine.hxx"
+#include "units/unit_base.hxx"
+
+using namespace std::chrono_literals;
+
+using namespace insys::nebulaxi;
+
+namespace {
+
+using bench_clock = std::chrono::steady_clock;
+
+template <typename value_type>
+inline void keep(const value_type& value)
+{
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+struct bench_options {
+    std::size_t boards { 2 };
+    std::size_t iterations { 100000 };
+    std::string filter {};
+    std::string output {};
+    std::filesystem::path record_dir {};
+    bool verbose {};
+};
+
+struct bench_result {
+    std::string name {};
+    std::size_t iterations {};
+    double ns_per_op {};
+    std::vector<std::pair<std::string, double>> metrics {};
+};
+
+class bench_suite final {
+    bench_options _options {};
+    std::vector<bench_result> _results {};
+
+public:
+    explicit bench_suite(bench_options options)
+        : _options { std::move(options) }
+    {
+    }
+
+    const bench_options& options() const noexcept { return _options; }
+
+    bool enabled(const std::string& name) const
+    {
+        return _options.filter.empty() || name.find(_options.filter) != std::string::npos;
+    }
+
+    ///
+    /// \brief Замер iterations вызовов fn после короткого прогрева.
+    ///
+    template <typename function_type>
+    bench_result* measure(const std::string& name, std::size_t iterations, function_type&& fn)
+    {
+        if (!enabled(name) || iterations == 0) {
+            return nullptr;
+        }
+        for (std::size_t i = 0; i < std::min<std::size_t>(iterations / 10, 1000); ++i) {
+            fn();
+        }
+        auto start = bench_clock::now();
+        for (std::size_t i = 0; i < iterations; ++i) {
+            fn();
+        }
+        std::chrono::duration<double, std::nano> elapsed { bench_clock::now() - start };
+        return &add(name, iterations, elapsed.count() / double(iterations));
+    }
+
+    bench_result& add(const std::string& name, std::size_t iterations, double ns_per_op)
+    {
+        _results.push_back({ name, iterations, ns_per_op, {} });
+        if (_options.verbose) {
+            std::cerr << name << ": " << ns_per_op << " ns/op" << std::endl;
+        }
+        return _results.back();
+    }
+
+    void write_json(std::ostream& stream) const
+    {
+        auto now = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch());
+        stream << "{\n  \"library\": \"nebulaxi\",\n  \"timestamp\": " << now.count()
+               << ",\n  \"boards\": " << _options.boards << ",\n  \"results\": [";
+        for (std::size_t i = 0; i < _results.size(); ++i) {
+            auto& result = _results[i];
+            stream << (i ? "," : "") << "\n    { \"name\": \"" << result.name << "\", \"iterations\": " << result.iterations
+                   << ", \"ns_per_op\": " << result.ns_per_op
+                   << ", \"ops_per_sec\": " << (result.ns_per_op > 0 ? 1e9 / result.ns_per_op : 0.0);
+            for (auto& [key, value] : result.metrics) {
+                stream << ", \"" << key << "\": " << value;
+            }
+            stream << " }";
+        }
+        stream << "\n  ]\n}\n";
+    }
+};
+
+///
+/// \brief Юнит для замеров доступа к регистрам, открывает защищенный интерфейс unit_base.
+///
+class bench_unit final : public unit_base<bench_unit> {
+public:
+    inline static const char* type { "bench" };
+    static constexpr auto type_id { is_u_type::NOT_SUPPORTED };
+
+    using reg_scratch = axi_reg_default<0x00>;
+    using reg_config = axi_reg_default<0x04>;
+    using field_enable = axi_field<0x04, 0, 1>;
+    using field_mode = axi_field<0x04, 4, 3>;
+    using field_divider = axi_field<0x08, 0, 16>;
+    using map_type = reg_map<axi_reg_default<0x00>, axi_reg_default<0x04>, axi_reg_default<0x08>, axi_reg_default<0x0C>,
+        axi_reg_default<0x10>, axi_reg_default<0x14>, axi_reg_default<0x18>, axi_reg_default<0x1C>>;
+
+    explicit bench_unit(const unit_data& data)
+        : base(data)
+    {
+    }
+
+    using base::field_write;
+    using base::get_reg_cache_stats;
+    using base::fields_write;
+    using base::reg_cache_declare;
+    using base::reg_map_read;
+    using base::reg_read;
+    using base::reg_write;
+};
+
+using bench_field = axi_field<0, 8, 5>;
+
+__attribute__((noinline)) uint32_t bench_axi_set_field(uint32_t reg, uint32_t value)
+{
+    return axi_reg_default<0> { reg }.set<bench_field>(value);
+}
+__attribute__((noinline)) uint32_t bench_manual_set_field(uint32_t reg, uint32_t value)
+{
+    return (reg & ~(0x1Fu << 8)) | ((value << 8) & (0x1Fu << 8));
+}
+__attribute__((noinline)) uint32_t bench_axi_get_field(uint32_t reg)
+{
+    return axi_reg_default<0> { reg }.get<bench_field>();
+}
+__attribute__((noinline)) uint32_t bench_manual_get_field(uint32_t reg)
+{
+    return (reg >> 8) & 0x1Fu;
+}
+
+std::vector<carrier> create_carriers(std::size_t count)
+{
+    std::vector<carrier> carriers {};
+    for (std::size_t index = 0; index < count; ++index) {
+        carriers.push_back(carrier_creator::create(io_type::simulate, index));
+    }
+    return carriers;
+}
+
+void bench_carrier_create(bench_suite& suite)
+{
+    constexpr std::size_t iterations { 50 };
+    suite.measure("carrier.io_create", iterations, [] {
+        keep(io_impl::create(io_type::simulate, 0));
+    });
+    auto io = io_impl::create(io_type::simulate, 0);
+    auto device_id = io->get_board_info().device_id;
+    suite.measure("carrier.config_cold", iterations, [&] {
+        carrier_config_cache::clear();
+        keep(carrier_config_cache::get(device_id));
+    });
+    suite.measure("carrier.config_warm", iterations * 100, [&] {
+        keep(carrier_config_cache::get(device_id));
+    });
+    auto config = carrier_config_cache::get(device_id);
+    if (!config) {
+        std::cerr << "carrier configuration not found, build phases skipped" << std::endl;
+    } else {
+        suite.measure("carrier.build_units_chips", iterations, [&] {
+            carrier_builder builder(io);
+            builder.build_units_chips(config->units);
+            keep(builder);
+        });
+        suite.measure("carrier.build_subsystems", iterations, [&] {
+            carrier_builder builder(io);
+            builder.build_units_chips(config->units);
+            builder.build_subsystems(config->subsystems);
+            keep(builder);
+        });
+    }
+    suite.measure("carrier.create", iterations, [] {
+        keep(carrier_creator::create(io_type::simulate, 0));
+    });
+}
+
+void bench_find_boards(bench_suite& suite)
+{
+    auto max_boards = resource_manager::get_max_boards();
+    for (std::size_t boards : { std::size_t(1), suite.options().boards, suite.options().boards * 4 }) {
+        resource_manager::set_max_boards(boards);
+        auto result = suite.measure("resource_manager.find_boards/" + std::to_string(boards), 10, [] {
+            resource_manager::find_boards();
+        });
+        if (result) {
+            result->metrics.emplace_back("found", double(resource_manager::get_boards().size()));
+        }
+    }
+    resource_manager::set_max_boards(max_boards);
+}
+
+void bench_registers(bench_suite& suite, const carrier& board)
+{
+    auto iterations = suite.options().iterations;
+    auto reg_main = board->units().get<reg>("reg_main");
+    suite.measure("reg.io_read", iterations, [io = board->get_io(), offset = reg_main->get_offset()] {
+        keep(io->reg_read(offset));
+    });
+    suite.measure("reg.unit_read", iterations, [&] {
+        keep(reg_main->read(0));
+    });
+
+    unit_data data { board->get_io(), {}, reg_main->get_offset(), "bench" };
+    bench_unit unit { data };
+    suite.measure("reg.reg_read", iterations, [&] {
+        keep(unit.reg_read<bench_unit::reg_scratch>());
+    });
+    suite.measure("reg.reg_write", iterations, [&] {
+        unit.reg_write(bench_unit::reg_scratch { 0x5A5A5A5A });
+    });
+    uint32_t value {};
+    suite.measure("reg.field_write", iterations, [&] {
+        unit.field_write<bench_unit::field_mode>(++value);
+    });
+    suite.measure("reg.field_write_x3", iterations, [&] {
+        unit.field_write<bench_unit::field_enable>(value & 1);
+        unit.field_write<bench_unit::field_mode>(++value);
+        unit.field_write<bench_unit::field_divider>(value);
+    });
+    suite.measure("reg.fields_write_x3", iterations, [&] {
+        ++value;
+        unit.fields_write<bench_unit::field_enable, bench_unit::field_mode, bench_unit::field_divider>(value & 1, value, value);
+    });
+    suite.measure("reg.read_x8", iterations, [&] {
+        for (std::size_t offset = 0; offset < bench_unit::map_type::size * sizeof(uint32_t); offset += sizeof(uint32_t)) {
+            keep(unit.reg_read(offset));
+        }
+    });
+    suite.measure("reg.reg_map_read_x8", iterations, [&] {
+        keep(unit.reg_map_read<bench_unit::map_type>());
+    });
+
+    unit_data cached_data { data };
+    cached_data.reg_cache.push_back({ bench_unit::reg_config::offset, reg_cache_policy::cached, 0 });
+    bench_unit cached_unit { cached_data };
+    auto result = suite.measure("reg.field_write_cached", iterations, [&] {
+        cached_unit.field_write<bench_unit::field_mode>(++value);
+    });
+    if (result) {
+        auto stats = cached_unit.get_reg_cache_stats();
+        result->metrics.emplace_back("cache_hits", double(stats.hits));
+        result->metrics.emplace_back("cache_misses", double(stats.misses));
+    }
+}
+
+void bench_axi_reg(bench_suite& suite)
+{
+    auto iterations = suite.options().iterations * 10;
+    uint32_t reg { 0x12345678 };
+    uint32_t value {};
+    suite.measure("axi_reg.set_field", iterations, [&] {
+        reg = bench_axi_set_field(reg, ++value);
+    });
+    suite.measure("axi_reg.manual_set_field", iterations, [&] {
+        reg = bench_manual_set_field(reg, ++value);
+    });
+    suite.measure("axi_reg.get_field", iterations, [&] {
+        keep(bench_axi_get_field(++reg));
+    });
+    suite.measure("axi_reg.manual_get_field", iterations, [&] {
+        keep(bench_manual_get_field(++reg));
+    });
+    for (uint32_t check : { 0u, 0xFFFFFFFFu, 0x12345678u }) {
+        if (bench_axi_set_field(check, 0x15) != bench_manual_set_field(check, 0x15)
+            || bench_axi_get_field(check) != bench_manual_get_field(check)) {
+            std::cerr << "axi_reg mismatch for " << check << std::endl;
+        }
+    }
+}
+
+inline const data_key<std::size_t> bench_key { "bench_key" };
+
+void bench_storages(bench_suite& suite, const carrier& board)
+{
+    auto iterations = suite.options().iterations;
+    data_storage storage {};
+    storage.add("bench_key", std::size_t { 42 });
+    storage.add(bench_key, std::size_t { 42 });
+    suite.measure("storage.data_get_string", iterations, [&] {
+        keep(storage.get<std::size_t>("bench_key"));
+    });
+    suite.measure("storage.data_get_key", iterations, [&] {
+        std::size_t value {};
+        storage.get(bench_key, value);
+        keep(value);
+    });
+    auto threads = std::max(2u, std::thread::hardware_concurrency());
+    auto result = suite.measure("storage.data_get_key_concurrent", 1, [&] {
+        std::vector<std::thread> readers {};
+        for (unsigned i = 0; i < threads; ++i) {
+            readers.emplace_back([&] {
+                for (std::size_t j = 0; j < iterations; ++j) {
+                    keep(storage.get_ptr(bench_key));
+                }
+            });
+        }
+        for (auto& reader : readers) {
+            reader.join();
+        }
+    });
+    if (result) {
+        result->ns_per_op /= double(iterations);
+        result->iterations = iterations;
+        result->metrics.emplace_back("threads", threads);
+    }
+
+    auto& units = board->units();
+    auto sysmon_offset = units.get<sysmon>("sysmon")->get_offset();
+    suite.measure("storage.unit_get", iterations, [&] {
+        keep(units.get<sysmon>());
+    });
+    suite.measure("storage.unit_get_name", iterations, [&] {
+        keep(units.get<sysmon>("sysmon"));
+    });
+    suite.measure("storage.unit_get_offset", iterations, [&] {
+        keep(units.get<sysmon>(sysmon_offset));
+    });
+    auto& subsystems = board->subsystems();
+    suite.measure("storage.subsystem_get", iterations, [&] {
+        keep(subsystems.get<icr_carrier>());
+    });
+    suite.measure("storage.subsystem_get_base", iterations, [&] {
+        keep(subsystems.get_base<icr_carrier>());
+    });
+}
+
+void bench_readouts(bench_suite& suite, const carrier& board)
+{
+    auto iterations = suite.options().iterations / 10;
+    auto monitor = board->units().get<sysmon>();
+    suite.measure("sysmon.get_temperature", iterations, [&] {
+        keep(monitor->get_temperature());
+    });
+    suite.measure("sysmon.readout", iterations, [&] {
+        keep(monitor->get_temperature());
+        keep(monitor->get_vcc_int());
+        keep(monitor->get_vcc_aux());
+        keep(monitor->get_vcc_bram());
+    });
+    monitor->start_sampling(1ms);
+    std::this_thread::sleep_for(10ms);
+    suite.measure("sysmon.get_snapshot", iterations, [&] {
+        sysmon_snapshot snapshot {};
+        keep(monitor->get_snapshot(snapshot));
+    });
+    monitor->stop_sampling();
+
+    auto icr = board->subsystems().get<icr_carrier>();
+    suite.measure("icr.get_raw_data", std::max<std::size_t>(iterations / 100, 10), [&] {
+        keep(icr->get_raw_data());
+    });
+}
+
+void bench_sdram_stream(bench_suite& suite, const carrier& board)
+{
+    sdram_stream sdram {};
+    if (!board->subsystems().get(sdram)) {
+        std::cerr << "sdram_stream not found, skipped" << std::endl;
+        return;
+    }
+    auto size = std::min<std::size_t>(sdram->get_capacity(), std::size_t(16) << 20);
+    std::vector<std::byte> data(size);
+    auto add_transfer = [&suite](const std::string& name, const sdram_stream_stats& stats) {
+        auto& result = suite.add(name, 1, double(stats.elapsed.count()) * 1e3);
+        result.metrics.emplace_back("bytes_per_sec", stats.bandwidth);
+        result.metrics.emplace_back("stalls", double(stats.stalls));
+    };
+    if (suite.enabled("sdram_stream.upload")) {
+        add_transfer("sdram_stream.upload", sdram->upload(data.data(), size));
+    }
+    if (suite.enabled("sdram_stream.download")) {
+        add_transfer("sdram_stream.download", sdram->download(data.data(), size));
+    }
+    if (suite.enabled("sdram_stream.record_drain")) {
+        auto start = bench_clock::now();
+        sdram->record(size);
+        if (!sdram->wait_recorded(2000ms)) {
+            std::cerr << "sdram_stream record timeout" << std::endl;
+            return;
+        }
+        uint64_t checksum {};
+        sdram->drain([&checksum](const std::byte* buffer, std::size_t count) { checksum += uint64_t(buffer[count - 1]); }, size);
+        keep(checksum);
+        std::chrono::duration<double> elapsed { bench_clock::now() - start };
+        auto& result = suite.add("sdram_stream.record_drain", 1, elapsed.count() * 1e9);
+        result.metrics.emplace_back("bytes_per_sec", double(size) / elapsed.count());
+    }
+}
+
+void bench_dma_ring(bench_suite& suite)
+{
+    for (std::size_t buffer_size : { std::size_t(64) << 10, std::size_t(1) << 20, std::size_t(4) << 20 }) {
+        for (std::size_t depth : { std::size_t(2), std::size_t(8) }) {
+            auto name = "dma_ring.loopback/" + std::to_string(buffer_size >> 10) + "k/" + std::to_string(depth);
+            if (!suite.enabled(name)) {
+                continue;
+            }
+            auto ring = std::make_shared<dma_ring>(buffer_size, depth);
+            dma_loopback_engine engine { ring };
+            engine.start();
+            std::size_t buffers {};
+            uint64_t bytes {};
+            double wait_max {};
+            auto start = bench_clock::now();
+            while (bench_clock::now() - start < 500ms) {
+                auto wait_start = bench_clock::now();
+                auto buffer = ring->acquire_filled(100ms);
+                if (!buffer) {
+                    break;
+                }
+                std::chrono::duration<double, std::nano> wait { bench_clock::now() - wait_start };
+                wait_max = std::max(wait_max, wait.count());
+                keep(buffer->data[0]);
+                bytes += buffer->used;
+                ++buffers;
+                ring->release(buffer);
+            }
+            std::chrono::duration<double> elapsed { bench_clock::now() - start };
+            engine.stop();
+            if (buffers == 0) {
+                continue;
+            }
+            auto& result = suite.add(name, buffers, elapsed.count() * 1e9 / double(buffers));
+            result.metrics.emplace_back("bytes_per_sec", double(bytes) / elapsed.count());
+            result.metrics.emplace_back("acquire_wait_max_ns", wait_max);
+            auto stats = ring->get_stats();
+            result.metrics.emplace_back("producer_stalls", double(stats.producer_stalls));
+            result.metrics.emplace_back("consumer_stalls", double(stats.consumer_stalls));
+        }
+    }
+}
+
+///
+/// \brief Масштабирование stream_group по числу плат: 1, 2, 4, ... до --boards.
+///
+void bench_stream_group(bench_suite& suite, const std::vector<carrier>& carriers)
+{
+    std::vector<std::size_t> counts {};
+    for (std::size_t count = 1; count < carriers.size(); count *= 2) {
+        counts.push_back(count);
+    }
+    counts.push_back(carriers.size());
+    for (auto count : counts) {
+        auto name = "stream_group.boards/" + std::to_string(count);
+        if (!suite.enabled(name)) {
+            continue;
+        }
+        board_list boards {};
+        for (std::size_t index = 0; index < count; ++index) {
+            boards.push_back({ carriers[index], {} });
+        }
+        stream_group group { boards };
+        group.start();
+        std::size_t buffers {};
+        auto start = bench_clock::now();
+        while (bench_clock::now() - start < 500ms) {
+            stream_packet packet {};
+            if (!group.acquire(packet, 100ms)) {
+                break;
+            }
+            keep(packet.buffer->data[0]);
+            group.release(packet);
+            ++buffers;
+        }
+        group.stop();
+        if (buffers == 0) {
+            continue;
+        }
+        auto stats = group.get_stats();
+        auto& result = suite.add(name, buffers, double(stats.elapsed.count()) * 1e3 / double(buffers));
+        result.metrics.emplace_back("bytes_per_sec", stats.bandwidth);
+        result.metrics.emplace_back("bytes_per_sec_per_board", stats.bandwidth / double(count));
+    }
+}
+
+void bench_stream_recorder(bench_suite& suite, const std::vector<carrier>& carriers)
+{
+    for (bool direct_io : { true, false }) {
+        std::string name { direct_io ? "stream_recorder.direct" : "stream_recorder.buffered" };
+        if (!suite.enabled(name)) {
+            continue;
+        }
+        auto directory = suite.options().record_dir / ("nebulaxi_bench_" + std::to_string(::getpid()));
+        board_list boards {};
+        for (auto& carrier : carriers) {
+            boards.push_back({ carrier, {} });
+        }
+        stream_group group { boards };
+        {
+            stream_recorder_config config {};
+            config.directory = directory;
+            config.segment_size = std::size_t(256) << 20;
+            config.direct_io = direct_io;
+            stream_recorder recorder { config };
+            group.start();
+            auto buffers = recorder.record(group, 1000ms);
+            group.stop();
+            recorder.close();
+            auto stats = recorder.get_stats();
+            if (buffers != 0) {
+                auto& result = suite.add(name, buffers, double(stats.elapsed.count()) * 1e3 / double(buffers));
+                result.metrics.emplace_back("bytes_per_sec", stats.bandwidth);
+                result.metrics.emplace_back("backpressure_waits", double(stats.backpressure_waits));
+                result.metrics.emplace_back("direct_io", stats.direct_io ? 1.0 : 0.0);
+            }
+        }
+        std::error_code error {};
+        std::filesystem::remove_all(directory, error);
+    }
+}
+
+bench_options parse_options(int argc, char* argv[])
+{
+    bench_options options {};
+    options.record_dir = std::filesystem::is_directory("/dev/shm") ? "/dev/shm" : std::filesystem::temp_directory_path();
+    for (int i = 1; i < argc; ++i) {
+        std::string option { argv[i] };
+        if (option == "--verbose") {
+            options.verbose = true;
+            continue;
+        }
+        if (i + 1 == argc) {
+            throw std::invalid_argument("missing value for option " + option);
+        }
+        std::string value { argv[++i] };
+        if (option == "--boards") {
+            options.boards = std::max<std::size_t>(std::stoul(value), 1);
+        } else if (option == "--iterations") {
+            options.iterations = std::max<std::size_t>(std::stoul(value), 10);
+        } else if (option == "--filter") {
+            options.filter = value;
+        } else if (option == "--output") {
+            options.output = value;
+        } else if (option == "--record-dir") {
+            options.record_dir = value;
+        } else {
+            throw std::invalid_argument("unknown option " + option);
+        }
+    }
+    return options;
+}
+
+}
+
+int main(int argc, char* argv[])
+try {
+    bench_suite suite { parse_options(argc, argv) };
+    bench_carrier_create(suite);
+    bench_find_boards(suite);
+    auto carriers = create_carriers(suite.options().boards);
+    bench_registers(suite, carriers.front());
+    bench_axi_reg(suite);
+    bench_storages(suite, carriers.front());
+    bench_readouts(suite, carriers.front());
+    bench_sdram_stream(suite, carriers.front());
+    bench_dma_ring(suite);
+    bench_stream_group(suite, carriers);
+    bench_stream_recorder(suite, carriers);
+    if (suite.options().output.empty()) {
+        suite.write_json(std::cout);
+    } else {
+        std::ofstream output { suite.options().output };
+        suite.write_json(output);
+    }
+    return 0;
+} catch (const std::exception& error) {
+    std::cerr << error.what() << std::endl;
+    return 1;
+}
@@ -8,6 +8,18 @@
 
 namespace insys::nebulaxi {
 
+///
+/// \brief Счетчики обращений к регистрам юнита носителя.
+///
+///
+struct unit_reg_access_stats {
+    std::string name {}; ///< Имя юнита.
+    std::size_t offset {}; ///< Смещение юнита.
+    reg_access_stats_list regs {}; ///< Счетчики по регистрам юнита.
+};
+
+using unit_reg_access_stats_list = std::vector<unit_reg_access_stats>;
+
 struct carrier_interface {
     virtual void reset() = 0;
     virtual const subsystem_storage& subsystems() const noexcept = 0;
@@ -17,6 +29,19 @@ struct carrier_interface {
     virtual std::string get_name() const noexcept = 0;
     virtual std::string get_version() const noexcept = 0;
     virtual std::string get_serial() const noexcept = 0;
+    ///
+    /// \brief Получение счетчиков обращений к регистрам по юнитам.
+    /// \details Счетчики ведутся, если библиотека собрана с NEBULAXI_REG_STATS, иначе список пуст.
+    /// Обращения подсистем к полям регистров учитываются в юните, через который они выполняются.
+    ///
+    /// \return Юниты, к регистрам которых были обращения.
+    ///
+    virtual unit_reg_access_stats_list get_reg_access_stats() const = 0;
+    ///
+    /// \brief Сброс счетчиков обращений к регистрам всех юнитов.
+    ///
+    ///
+    virtual void reg_access_stats_reset() noexcept = 0;
     virtual ~carrier_interface() noexcept = default;
 };
 
@@ -1,11 +1,17 @@
 #pragma once
 
 #include <any>
+#include <array>
+#include <atomic>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <stdexcept>
+#include <string>
 #include <typeindex>
 #include <utility>
+#include <vector>
 
 #include "nebulaxi/nebulaxi_error.hpp"
 
@@ -22,18 +28,103 @@ public:
 
 namespace detail {
     ///
-    /// \brief Данные хранилища
+    /// \brief Номер сегмента блокировки для текущего потока.
+    ///
+    ///
+    inline std::size_t data_storage_thread_shard() noexcept
+    {
+        static std::atomic<std::size_t> next_shard {};
+        thread_local std::size_t shard { next_shard.fetch_add(1, std::memory_order_relaxed) };
+        return shard;
+    }
     ///
+    /// \brief Данные хранилища
+    /// \details Доступ защищен сегментированной блокировкой чтения-записи: читатель блокирует
+    /// только сегмент своего потока, писатель - все сегменты. Так чтение из разных потоков
+    /// не конкурирует за одну линию кэша.
     ///
     struct data_storage_private_data {
+        static constexpr std::size_t shards_count { 16 };
+        struct alignas(64) lock_shard {
+            std::shared_mutex mutex {};
+        };
+        mutable std::array<lock_shard, shards_count> shards {};
+
+        auto read_lock() const
+        {
+            return std::shared_lock { shards[data_storage_thread_shard() % shards_count].mutex };
+        }
+        void lock() const
+        {
+            for (auto& shard : shards) {
+                shard.mutex.lock();
+            }
+        }
+        void unlock() const noexcept
+        {
+            for (auto shard = shards.rbegin(); shard != shards.rend(); ++shard) {
+                shard->mutex.unlock();
+            }
+        }
+        auto write_lock() const { return std::unique_lock { *this }; }
+
         /// \brief Карта для хранения данных
         ///
         /// \tparam std::type_index Идентификатор данных
         /// \tparam std::any Хранитель данных
         std::map<std::string, std::pair<std::type_index, std::any>> map {};
+        /// \brief Значения по типизированным ключам
+        ///
+        /// Индекс элемента - индекс ключа data_key. Значение хранится в отдельном узле,
+        /// поэтому рост массива не перемещает его и выданные указатели остаются действительными.
+        std::vector<std::unique_ptr<std::any>> slots {};
+
+        std::any* slot(std::size_t index) const noexcept
+        {
+            return index < slots.size() ? slots[index].get() : nullptr;
+        }
     };
+
+    ///
+    /// \brief Индекс ключа по имени и типу значения.
+    /// \details Ключи с одинаковыми именем и типом получают один индекс, так что повторно
+    /// создаваемые ключи не увеличивают массив значений хранилищ.
+    ///
+    inline std::size_t data_key_index(const char* name, std::type_index type)
+    {
+        static std::mutex mutex {};
+        static std::map<std::pair<std::string, std::type_index>, std::size_t> indexes {};
+        std::lock_guard lock { mutex };
+        return indexes.try_emplace({ name, type }, indexes.size()).first->second;
+    }
 }
 
+///
+/// \brief Типизированный ключ хранилища данных.
+/// \details Ключ несет тип значения и получает уникальный индекс при создании,
+/// поэтому поиск по нему - обращение к элементу массива без выделения памяти.
+/// Ключи объявляются один раз, например: `inline const data_key<int> some_key { "some_key" };`
+/// Создание ключа требует блокировки, поэтому ключи не следует создавать на горячем пути.
+///
+/// \tparam data_type Тип значения.
+///
+template <typename data_type>
+class data_key final {
+    std::size_t _index {};
+    const char* _name {};
+
+public:
+    using value_type = data_type;
+
+    explicit data_key(const char* name)
+        : _index { detail::data_key_index(name, std::type_index(typeid(data_type))) }
+        , _name { name }
+    {
+    }
+    std::size_t index() const noexcept { return _index; }
+    const char* name() const noexcept { return _name; }
+};
+
 #define DATA_STORAGE_ADD_VALUE(STORAGE, PARAMETR) STORAGE.add(#PARAMETR, PARAMETR)
 #define DATA_STORAGE_HAS_VALUE(STORAGE, PARAMETR) STORAGE.has_data<decltype(PARAMETR)>(#PARAMETR)
 #define DATA_STORAGE_GET_VALUE(STORAGE, PARAMETR) PARAMETR = STORAGE.get<decltype(PARAMETR)>(#PARAMETR)
@@ -43,6 +134,8 @@ namespace detail {
 ///
 /// \brief Хранилище данных
 /// \details Данный класс реализует хранилище данных, можно хранить любой тип данных. Поиск значения осуществляется по ключу.
+/// Копии хранилища разделяют данные, доступ к ним из разных потоков безопасен. Ссылки и указатели,
+/// полученные через get_ref() и get_ptr(), действительны до удаления значения.
 ///
 class data_storage final {
     std::shared_ptr<detail::data_storage_private_data> d_ptr { std::make_shared<detail::data_storage_private_data>() };
@@ -67,11 +160,13 @@ public:
     template <typename data_type>
     bool add(const std::string& name, const data_type& data)
     {
+        auto lock = d_ptr->write_lock();
         return d_ptr->map.emplace(name, std::make_pair(std::type_index(typeid(data_type)), data)).second;
     }
     template <typename data_type>
     data_type get(const std::string& name) const
     {
+        auto lock = d_ptr->read_lock();
         auto it_data = d_ptr->map.find(name);
         if (it_data != d_ptr->map.end() && std::type_index(typeid(data_type)) == it_data->second.first) {
             try {
@@ -84,6 +179,7 @@ public:
     template <typename data_type>
     data_type& get_ref(const std::string& name) const
     {
+        auto lock = d_ptr->read_lock();
         auto it_data = d_ptr->map.find(name);
         if (it_data != d_ptr->map.end() && std::type_index(typeid(data_type)) == it_data->second.first) {
             try {
@@ -96,6 +192,7 @@ public:
     template <typename data_type>
     bool get(const std::string& name, data_type& data) const noexcept
     try {
+        auto lock = d_ptr->read_lock();
         auto it_data = d_ptr->map.find(name);
         if (it_data != d_ptr->map.end() && std::type_index(typeid(data_type)) == it_data->second.first) {
             try {
@@ -111,6 +208,7 @@ public:
     template <typename data_type>
     void remove(const std::string& name)
     {
+        auto lock = d_ptr->write_lock();
         auto it_data = d_ptr->map.find(name);
         if (it_data != d_ptr->map.end() && std::type_index(typeid(data_type)) == it_data->second.first) {
             try {
@@ -125,6 +223,7 @@ public:
     template <typename data_type>
     bool has_data(const std::string& name) const
     {
+        auto lock = d_ptr->read_lock();
         auto it_data = d_ptr->map.find(name);
         if (it_data != d_ptr->map.end() && std::type_index(typeid(data_type)) == it_data->second.first) {
             try {
@@ -135,15 +234,112 @@ public:
         }
         return false;
     }
-    auto size() const noexcept { return d_ptr->map.size(); }
-    auto empty() const noexcept { return d_ptr->map.empty(); }
-    void clear() noexcept { d_ptr->map.clear(); }
+    ///
+    /// \brief Добавление значения по типизированному ключу.
+    ///
+    /// \return \retval true значение добавлено \retval false значение по ключу уже есть.
+    ///
+    template <typename data_type>
+    bool add(const data_key<data_type>& key, const data_type& data)
+    {
+        auto lock = d_ptr->write_lock();
+        auto& slots = d_ptr->slots;
+        if (key.index() >= slots.size()) {
+            slots.resize(key.index() + 1);
+        }
+        auto& slot = slots[key.index()];
+        if (slot && slot->has_value()) {
+            return false;
+        }
+        slot = std::make_unique<std::any>(data);
+        return true;
+    }
+    ///
+    /// \brief Получение значения по типизированному ключу.
+    ///
+    /// \return Указатель на значение или nullptr, если значения нет.
+    ///
+    template <typename data_type>
+    data_type* get_ptr(const data_key<data_type>& key) const
+    {
+        auto lock = d_ptr->read_lock();
+        return std::any_cast<data_type>(d_ptr->slot(key.index()));
+    }
+    template <typename data_type>
+    bool get(const data_key<data_type>& key, data_type& data) const noexcept
+    try {
+        auto lock = d_ptr->read_lock();
+        if (auto value = std::any_cast<data_type>(d_ptr->slot(key.index()))) {
+            data = *value;
+            return true;
+        }
+        return false;
+    } catch (...) {
+        return false;
+    }
+    template <typename data_type>
+    bool has_data(const data_key<data_type>& key) const noexcept
+    try {
+        return get_ptr(key) != nullptr;
+    } catch (...) {
+        return false;
+    }
+    template <typename data_type>
+    bool remove(const data_key<data_type>& key) noexcept
+    {
+        auto lock = d_ptr->write_lock();
+        auto slot = d_ptr->slot(key.index());
+        if (!slot || !slot->has_value()) {
+            return false;
+        }
+        d_ptr->slots[key.index()].reset();
+        return true;
+    }
+    /// Число значений по строковым ключам (значения по типизированным ключам не учитываются).
+    auto size() const noexcept
+    {
+        auto lock = d_ptr->read_lock();
+        return d_ptr->map.size();
+    }
+    auto empty() const noexcept
+    {
+        auto lock = d_ptr->read_lock();
+        return d_ptr->map.empty();
+    }
+    void clear() noexcept
+    {
+        auto lock = d_ptr->write_lock();
+        d_ptr->map.clear();
+        d_ptr->slots.clear();
+    }
+    /// Обход хранилища не защищен блокировкой и допустим только при отсутствии конкурентных писателей.
     auto begin() noexcept { return d_ptr->map.begin(); }
     auto end() noexcept { return d_ptr->map.end(); }
     auto begin() const noexcept { return d_ptr->map.begin(); }
     auto end() const noexcept { return d_ptr->map.end(); }
     auto cbegin() const noexcept { return d_ptr->map.cbegin(); }
     auto cend() const noexcept { return d_ptr->map.cend(); }
-    void merge(const data_storage& other) noexcept { d_ptr->map.merge(other.d_ptr->map); }
+    void merge(const data_storage& other)
+    {
+        if (d_ptr == other.d_ptr) {
+            return;
+        }
+        // порядок захвата по адресу исключает взаимную блокировку встречных merge
+        auto first = std::min(d_ptr.get(), other.d_ptr.get());
+        auto second = std::max(d_ptr.get(), other.d_ptr.get());
+        auto first_lock = first->write_lock();
+        auto second_lock = second->write_lock();
+        d_ptr->map.merge(other.d_ptr->map);
+        auto& slots = d_ptr->slots;
+        auto& other_slots = other.d_ptr->slots;
+        if (slots.size() < other_slots.size()) {
+            slots.resize(other_slots.size());
+        }
+        for (std::size_t index {}; index < other_slots.size(); ++index) {
+            if (!d_ptr->slot(index) && other_slots[index]) {
+                slots[index] = std::move(other_slots[index]);
+            }
+        }
+    }
 };
 }
@@ -1,8 +1,13 @@
 #pragma once
 
+#include <array>
 #include <cinttypes>
 #include <cstddef>
 #include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 /// Пространство имен библиотеки Nebula-XI
 
@@ -28,43 +33,61 @@ struct axi_reg_bitmask_default {
 template <typename bitmask_type, std::size_t offset_value>
 class axi_reg {
     using value_type = bitmask_type;
-    union data_type {
-        uint32_t value;
-        value_type bits;
-    } _data {};
+    static_assert(sizeof(value_type) == sizeof(uint32_t), "register bitmask must be 32 bits wide");
 
 public:
-    axi_reg() = default;
-    axi_reg(const axi_reg& other) { operator=(other); }
-    axi_reg& operator=(const axi_reg& other)
+    union {
+        uint32_t value; ///< Значение регистра.
+        value_type bits; ///< Битовое представление регистра.
+    };
+    static constexpr std::size_t offset { offset_value };
+
+    constexpr axi_reg() noexcept
+        : value {}
+    {
+    }
+    constexpr axi_reg(uint32_t value) noexcept
+        : value { value }
+    {
+    }
+    constexpr axi_reg(const value_type& bitmask) noexcept
+        : bits { bitmask }
     {
-        if (this != &other) {
-            this->_data.value = other.value;
-        }
-        return *this;
     }
-    axi_reg(axi_reg&&) noexcept = default;
-    axi_reg& operator=(axi_reg&&) noexcept = default;
-    axi_reg(uint32_t value) { operator=(value); }
-    axi_reg& operator=(uint32_t value)
+    constexpr axi_reg& operator=(uint32_t value) noexcept
     {
-        this->_data.value = value;
+        this->value = value;
         return *this;
     }
-    operator uint32_t()
+    constexpr operator uint32_t() const noexcept
     {
-        return _data.value;
+        return value;
     }
-    axi_reg(const value_type& bitmask)
-        : _data { bitmask }
+    auto operator->() noexcept { return &bits; }
+    auto operator->() const noexcept { return &bits; }
+    ///
+    /// \brief Чтение битового поля регистра.
+    ///
+    /// \tparam field_type тип битового поля этого регистра.
+    ///
+    template <typename field_type>
+    constexpr uint32_t get() const noexcept
     {
+        static_assert(field_type::offset == offset, "field belongs to another register");
+        return (value & field_type::bit_mask) >> field_type::bit_offset;
+    }
+    ///
+    /// \brief Запись битового поля регистра.
+    ///
+    /// \tparam field_type тип битового поля этого регистра.
+    ///
+    template <typename field_type>
+    constexpr axi_reg& set(uint32_t field_value) noexcept
+    {
+        static_assert(field_type::offset == offset, "field belongs to another register");
+        value = (value & ~uint32_t(field_type::bit_mask)) | ((field_value << field_type::bit_offset) & field_type::bit_mask);
+        return *this;
     }
-    virtual ~axi_reg() noexcept = default;
-    auto operator->() noexcept { return &_data.bits; }
-    auto operator->() const noexcept { return &_data.bits; }
-    value_type volatile& bits { _data.bits };
-    uint32_t volatile& value { _data.value };
-    static constexpr std::size_t offset { offset_value };
 };
 
 ///
@@ -85,33 +108,40 @@ using axi_reg_default = axi_reg<axi_reg_bitmask_default, offset_value>;
 ///
 template <std::size_t offset_value, std::size_t bit_offset_value, std::size_t bit_width_value, typename value_type = std::size_t>
 class reg_field {
+    static constexpr std::size_t value_bits = sizeof(value_type) * 8;
+    static_assert(bit_width_value > 0 && bit_offset_value + bit_width_value <= value_bits, "field does not fit the register");
+
     value_type _value {};
 
 public:
     using reg_type = value_type;
     static constexpr std::size_t offset = offset_value;
     static constexpr std::size_t bit_offset = bit_offset_value;
-    static constexpr std::size_t bit_mask = ((1 << bit_width_value) - 1) << bit_offset_value;
+    static constexpr std::size_t bit_width = bit_width_value;
+    static constexpr reg_type bit_mask = (bit_width_value == value_bits
+                                                 ? ~reg_type {}
+                                                 : ((reg_type { 1 } << (bit_width_value % value_bits)) - 1))
+        << bit_offset_value;
 
-    constexpr reg_field(const reg_field&) noexcept = default;
-    constexpr reg_field& operator=(const reg_field&) noexcept = default;
-    constexpr reg_field(reg_field&&) noexcept = default;
-    constexpr reg_field& operator=(reg_field&&) noexcept = default;
-    constexpr reg_field(reg_type value) { operator=(value); }
-    constexpr reg_field& operator=(reg_type value)
+    constexpr reg_field() noexcept = default;
+    constexpr reg_field(reg_type value) noexcept
+        : _value { value }
+    {
+    }
+    constexpr reg_field& operator=(reg_type value) noexcept
     {
         _value = value;
         return *this;
     }
-    constexpr operator reg_type()
+    constexpr operator reg_type() const noexcept
     {
         return _value;
     }
-    constexpr reg_type get_field()
+    constexpr reg_type get_field() const noexcept
     {
         return (_value & reg_field::bit_mask) >> reg_field::bit_offset;
     }
-    constexpr reg_field& set_field(reg_type value)
+    constexpr reg_field& set_field(reg_type value) noexcept
     {
         _value &= ~reg_field::bit_mask;
         _value |= (value << reg_field::bit_offset) & reg_field::bit_mask;
@@ -131,6 +161,188 @@ using axi_field = reg_field<offset_value, bit_offset_value, bit_width_value, uin
 template <std::size_t offset_value, std::size_t bit_offset_value, std::size_t bit_width_value>
 using drp_field = reg_field<offset_value, bit_offset_value, bit_width_value, uint32_t>;
 
+static_assert(std::is_trivially_copyable_v<axi_reg_default<0>> && sizeof(axi_reg_default<0>) == sizeof(uint32_t));
+static_assert(std::is_trivially_copyable_v<axi_field<0, 0, 1>> && sizeof(axi_field<0, 0, 1>) == sizeof(uint32_t));
+static_assert(axi_field<0, 31, 1>::bit_mask == 0x80000000u && axi_field<0, 0, 32>::bit_mask == 0xFFFFFFFFu);
+static_assert(axi_field<0, 4, 8> { 0x12345678u }.get_field() == 0x67u);
+static_assert(uint32_t(axi_field<0, 4, 8> { 0xFFFFFFFFu }.set_field(0)) == 0xFFFFF00Fu);
+static_assert(axi_reg_default<0> { 0xF0u }.get<axi_field<0, 4, 4>>() == 0xFu);
+
+///
+/// \brief Значение поля в групповых операциях с битовыми полями.
+///
+template <typename field_type>
+using reg_field_value = uint32_t;
+
+namespace detail {
+
+    template <typename... field_types>
+    constexpr std::array<std::size_t, sizeof...(field_types)> reg_fields_offsets { field_types::offset... };
+
+    ///
+    /// \brief Проверка, что поле с индексом index - первое среди полей своего регистра.
+    ///
+    template <std::size_t index, typename... field_types>
+    constexpr bool reg_field_first_in_reg()
+    {
+        constexpr auto offsets = reg_fields_offsets<field_types...>;
+        for (std::size_t i = 0; i < index; ++i) {
+            if (offsets[i] == offsets[index])
+                return false;
+        }
+        return true;
+    }
+
+    ///
+    /// \brief Объединенная маска полей, лежащих в регистре offset.
+    ///
+    template <std::size_t offset, typename... field_types>
+    constexpr uint32_t reg_fields_mask()
+    {
+        return (uint32_t {} | ... | (field_types::offset == offset ? uint32_t(field_types::bit_mask) : uint32_t {}));
+    }
+
+    ///
+    /// \brief Проверка, что поля одного регистра не пересекаются.
+    ///
+    template <typename... field_types>
+    constexpr bool reg_fields_disjoint()
+    {
+        constexpr std::array<std::size_t, sizeof...(field_types)> offsets { field_types::offset... };
+        constexpr std::array<uint32_t, sizeof...(field_types)> masks { uint32_t(field_types::bit_mask)... };
+        for (std::size_t i = 0; i < offsets.size(); ++i) {
+            for (std::size_t j = i + 1; j < offsets.size(); ++j) {
+                if (offsets[i] == offsets[j] && (masks[i] & masks[j]))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    ///
+    /// \brief Сборка значений полей, лежащих в регистре offset.
+    ///
+    template <std::size_t offset, typename... field_types>
+    constexpr uint32_t reg_fields_pack(const std::array<uint32_t, sizeof...(field_types)>& values)
+    {
+        constexpr std::array<std::size_t, sizeof...(field_types)> offsets { field_types::offset... };
+        constexpr std::array<std::size_t, sizeof...(field_types)> bit_offsets { field_types::bit_offset... };
+        constexpr std::array<uint32_t, sizeof...(field_types)> masks { uint32_t(field_types::bit_mask)... };
+        uint32_t result {};
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            if (offsets[i] == offset)
+                result |= (values[i] << bit_offsets[i]) & masks[i];
+        }
+        return result;
+    }
+
+    ///
+    /// \brief Извлечение значений полей, лежащих в регистре offset.
+    ///
+    template <std::size_t offset, typename... field_types>
+    constexpr void reg_fields_unpack(uint32_t value, std::array<uint32_t, sizeof...(field_types)>& values)
+    {
+        constexpr std::array<std::size_t, sizeof...(field_types)> offsets { field_types::offset... };
+        constexpr std::array<std::size_t, sizeof...(field_types)> bit_offsets { field_types::bit_offset... };
+        constexpr std::array<uint32_t, sizeof...(field_types)> masks { uint32_t(field_types::bit_mask)... };
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            if (offsets[i] == offset)
+                values[i] = (value & masks[i]) >> bit_offsets[i];
+        }
+    }
+
+    template <typename... field_types, typename read_function, typename write_function, std::size_t... index>
+    void reg_fields_write(read_function& read, write_function& write,
+        const std::array<uint32_t, sizeof...(field_types)>& values, std::index_sequence<index...>)
+    {
+        (
+            [&] {
+                using field_type = std::tuple_element_t<index, std::tuple<field_types...>>;
+                if constexpr (reg_field_first_in_reg<index, field_types...>()) {
+                    constexpr auto mask = reg_fields_mask<field_type::offset, field_types...>();
+                    uint32_t value {};
+                    if constexpr (mask != UINT32_MAX) {
+                        value = read(field_type::offset) & ~mask;
+                    }
+                    write(field_type::offset, value | reg_fields_pack<field_type::offset, field_types...>(values));
+                }
+            }(),
+            ...);
+    }
+
+    template <typename... field_types, typename read_function, std::size_t... index>
+    void reg_fields_read(read_function& read, std::array<uint32_t, sizeof...(field_types)>& values, std::index_sequence<index...>)
+    {
+        (
+            [&] {
+                using field_type = std::tuple_element_t<index, std::tuple<field_types...>>;
+                if constexpr (reg_field_first_in_reg<index, field_types...>()) {
+                    reg_fields_unpack<field_type::offset, field_types...>(read(field_type::offset), values);
+                }
+            }(),
+            ...);
+    }
+
+}
+
+///
+/// \brief Групповая запись битовых полей.
+/// \details Поля группируются по смещению регистра на этапе компиляции,
+/// для каждого регистра выполняется одно чтение-модификация-запись.
+/// Если поля полностью покрывают регистр, чтение не выполняется.
+///
+/// \tparam field_types типы битовых полей.
+/// \param read функция чтения регистра по смещению.
+/// \param write функция записи регистра по смещению.
+/// \param values значения полей в порядке field_types.
+///
+template <typename... field_types, typename read_function, typename write_function>
+void reg_fields_write(read_function&& read, write_function&& write, reg_field_value<field_types>... values)
+{
+    static_assert(detail::reg_fields_disjoint<field_types...>(), "register fields overlap");
+    detail::reg_fields_write<field_types...>(read, write, { values... }, std::index_sequence_for<field_types...> {});
+}
+
+///
+/// \brief Групповое чтение битовых полей, по одному чтению на регистр.
+///
+/// \tparam field_types типы битовых полей.
+/// \param read функция чтения регистра по смещению.
+/// \return Значения полей в порядке field_types.
+///
+template <typename... field_types, typename read_function>
+std::array<uint32_t, sizeof...(field_types)> reg_fields_read(read_function&& read)
+{
+    std::array<uint32_t, sizeof...(field_types)> values {};
+    detail::reg_fields_read<field_types...>(read, values, std::index_sequence_for<field_types...> {});
+    return values;
+}
+
+///
+/// \brief Тип операции пакетного доступа к регистрам.
+///
+///
+enum class reg_op {
+    read, ///< Чтение регистра.
+    write ///< Запись регистра.
+};
+
+///
+/// \brief Элемент пакетного доступа к регистрам.
+///
+///
+struct reg_transfer {
+    std::size_t offset {}; ///< Смещение регистра.
+    uint32_t value {}; ///< Записываемое или прочитанное значение.
+    reg_op op { reg_op::read }; ///< Тип операции.
+};
+
+///
+/// \brief Список элементов пакетного доступа к регистрам.
+///
+///
+using reg_batch = std::vector<reg_transfer>;
+
 ///
 /// \brief Супер ENUM :-)
 ///
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "nebulaxi/io/io.hpp"
@@ -26,17 +28,57 @@ struct board {
 using board_info_list = std::vector<board_info>;
 using board_list = std::vector<board>;
 
+///
+/// \brief Неизменяемый реестр найденных плат с индексами по серийному номеру и по шине.слоту.
+///
+///
+class board_registry final {
+    board_list _boards {};
+    std::unordered_map<std::string, std::size_t> _by_serial {};
+    std::unordered_map<uint64_t, std::size_t> _by_location {};
+
+    static uint64_t location_key(const io_locaction&) noexcept;
+
+public:
+    board_registry() = default;
+    explicit board_registry(board_list);
+
+    const board_list& boards() const noexcept { return _boards; }
+    auto size() const noexcept { return _boards.size(); }
+    auto empty() const noexcept { return _boards.empty(); }
+    ///
+    /// \brief Поиск платы по серийному номеру носителя.
+    ///
+    /// \return Плата или nullptr, если не найдена.
+    ///
+    const board* find_by_carrier_serial(const std::string&) const noexcept;
+    ///
+    /// \brief Поиск платы по расположению носителя (шина.слот).
+    ///
+    /// \return Плата или nullptr, если не найдена.
+    ///
+    const board* find_by_carrier_location(const io_locaction&) const noexcept;
+};
+
+/// Разделяемый снимок реестра плат.
+using board_registry_snapshot = std::shared_ptr<const board_registry>;
+
 class resource_manager final {
     struct private_data;
     static std::shared_ptr<private_data> d_ptr;
 
+    static void discover();
+
 public:
     static void set_max_boards(std::size_t) noexcept;
     static std::size_t get_max_boards() noexcept;
+    static void set_max_threads(std::size_t) noexcept;
+    static std::size_t get_max_threads() noexcept;
 
     static board_info_list get_boards_info();
     static void find_boards();
     static board_list get_boards();
+    static board_registry_snapshot get_registry();
 
     static board find_by_carrier_serial(const std::string&);
     static board find_by_carrier_location(const io_locaction&);
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "nebulaxi/resource_manager.hpp"
+#include "nebulaxi/subsystems/dma_ring.hpp"
+
+namespace insys::nebulaxi {
+
+///
+/// \brief Источник потока C2H одной платы.
+/// \details Заполняет кольцо буферов, которое читает рабочий поток группы.
+///
+///
+struct stream_source_interface {
+    virtual dma_ring& get_ring() = 0;
+    virtual void start() = 0;
+    virtual void stop() noexcept = 0;
+    virtual ~stream_source_interface() noexcept = default;
+};
+
+using stream_source = std::shared_ptr<stream_source_interface>;
+
+///
+/// \brief Параметры группы потоков.
+///
+///
+struct stream_group_config {
+    std::size_t buffer_size { 1 << 20 }; ///< Размер буфера кольца.
+    std::size_t depth { 8 }; ///< Число буферов кольца каждой платы.
+    bool pin_workers { true }; ///< Привязывать рабочие потоки к узлу NUMA платы.
+};
+
+///
+/// \brief Буфер потока с меткой платы.
+///
+///
+struct stream_packet {
+    std::size_t board_index {}; ///< Индекс платы в группе.
+    io_locaction location {}; ///< Расположение платы.
+    const dma_buffer* buffer {}; ///< Данные, действительны до release.
+    uint64_t generation {}; ///< Номер запуска группы, в котором получен буфер.
+};
+
+///
+/// \brief Статистика потока одной платы.
+///
+///
+struct stream_board_stats {
+    io_locaction location {}; ///< Расположение платы.
+    int numa_node { -1 }; ///< Узел NUMA платы, -1 - неизвестен.
+    uint64_t buffers {}; ///< Переданные буферы.
+    uint64_t bytes {}; ///< Переданные байты.
+    double bandwidth {}; ///< Скорость, байт/с.
+};
+
+///
+/// \brief Статистика группы потоков.
+///
+///
+struct stream_group_stats {
+    std::vector<stream_board_stats> boards {}; ///< Статистика по платам.
+    uint64_t bytes {}; ///< Всего байтов.
+    double bandwidth {}; ///< Суммарная скорость, байт/с.
+    std::chrono::microseconds elapsed {}; ///< Время работы.
+};
+
+///
+/// \brief Одновременный прием потоков C2H с нескольких плат.
+/// \details На каждую плату запускается рабочий поток, привязанный к процессорам узла NUMA,
+/// ближайшего к устройству. Кольцо буферов создается и заполняется в этом потоке, поэтому
+/// память выделяется на том же узле. Буферы всех плат поступают в общую очередь с меткой платы.
+///
+class stream_group final {
+    struct private_data;
+    std::shared_ptr<private_data> d_ptr {};
+
+public:
+    ///
+    /// \brief Фабрика источника потока платы, вызывается в рабочем потоке платы.
+    ///
+    using source_factory = std::function<stream_source(const board&, const stream_group_config&)>;
+
+    ///
+    /// \brief Конструктор группы.
+    ///
+    /// \param boards Платы.
+    /// \param config Параметры.
+    /// \param factory Фабрика источников, по умолчанию - генератор для симулируемых плат
+    /// (для аппаратных плат источник по умолчанию не предусмотрен).
+    ///
+    explicit stream_group(const board_list& boards, const stream_group_config& config = {}, source_factory factory = {});
+    stream_group(const stream_group&) = delete;
+    stream_group& operator=(const stream_group&) = delete;
+    ~stream_group() noexcept;
+
+    void start();
+    void stop() noexcept;
+    bool is_running() const noexcept;
+    std::size_t size() const noexcept;
+    ///
+    /// \brief Получение следующего буфера любой платы.
+    ///
+    /// \param[out] packet Буфер с меткой платы.
+    /// \param timeout Время ожидания.
+    /// \return \retval true буфер получен \retval false время истекло или группа остановлена.
+    ///
+    bool acquire(stream_packet& packet, std::chrono::microseconds timeout);
+    ///
+    /// \brief Возврат буфера, порядок возврата произвольный.
+    /// \details Буферы предыдущего запуска после перезапуска группы не возвращаются и игнорируются:
+    /// start сбрасывает кольца, и их данные уже недействительны.
+    ///
+    void release(const stream_packet& packet);
+    stream_group_stats get_stats() const;
+};
+
+class stream_group_error : public nebulaxi_error {
+
+public:
+    stream_group_error(const std::string&);
+    virtual ~stream_group_error() noexcept = default;
+};
+
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "nebulaxi/nebulaxi_error.hpp"
+#include "nebulaxi/stream_group.hpp"
+
+namespace insys::nebulaxi {
+
+///
+/// \brief Параметры записи потока на диск.
+///
+///
+struct stream_recorder_config {
+    std::filesystem::path directory {}; ///< Каталог записи.
+    std::string prefix { "stream" }; ///< Префикс имен файлов.
+    std::size_t segment_size { std::size_t(1) << 30 }; ///< Размер сегмента (файла) данных.
+    std::size_t writers { 2 }; ///< Число потоков записи.
+    std::size_t queue_depth { 16 }; ///< Число буферов в очереди, при заполнении submit ожидает.
+    bool direct_io { true }; ///< Запись в обход кэша ОС (O_DIRECT), если поддерживается.
+};
+
+///
+/// \brief Запись индексного файла, по одной на буфер.
+/// \details Данные буфера лежат в сегменте segment по смещению offset, за ними до границы блока - нули.
+/// Записи упорядочены по sequence, буферы, запись которых не удалась, в индекс не попадают.
+///
+///
+struct stream_index_entry {
+    uint64_t sequence {}; ///< Порядковый номер буфера в записи.
+    uint64_t timestamp {}; ///< Время поступления, нс от эпохи system_clock.
+    uint32_t source {}; ///< Источник (индекс платы).
+    uint32_t segment {}; ///< Номер сегмента.
+    uint64_t offset {}; ///< Смещение в сегменте.
+    uint64_t size {}; ///< Размер данных.
+};
+
+///
+/// \brief Статистика записи.
+///
+///
+struct stream_recorder_stats {
+    uint64_t buffers {}; ///< Записанные буферы.
+    uint64_t bytes {}; ///< Записанные байты данных.
+    uint64_t segments {}; ///< Открытые сегменты.
+    uint64_t backpressure_waits {}; ///< Ожидания submit при заполненной очереди.
+    bool direct_io {}; ///< Запись выполняется в обход кэша ОС.
+    std::chrono::microseconds elapsed {}; ///< Время записи.
+    double bandwidth {}; ///< Скорость, байт/с.
+};
+
+///
+/// \brief Запись буферов потока на диск.
+/// \details Буферы записываются без копирования пулом потоков в заранее выделенные файлы-сегменты
+/// <prefix>_<N>.dat, описание каждого буфера добавляется в <prefix>.index. Данные не отбрасываются:
+/// при заполненной очереди submit ожидает освобождения места.
+///
+class stream_recorder final {
+    struct private_data;
+    std::shared_ptr<private_data> d_ptr {};
+
+public:
+    explicit stream_recorder(const stream_recorder_config& config);
+    stream_recorder(const stream_recorder&) = delete;
+    stream_recorder& operator=(const stream_recorder&) = delete;
+    ///
+    /// \brief Деструктор, дописывает очередь и закрывает файлы.
+    ///
+    ~stream_recorder() noexcept;
+    ///
+    /// \brief Постановка буфера в очередь записи.
+    ///
+    /// \param buffer Буфер, данные должны оставаться действительными до вызова on_written.
+    /// \param source Источник (индекс платы).
+    /// \param on_written Вызывается из потока записи после записи (или ошибки записи).
+    ///
+    void submit(const dma_buffer& buffer, uint32_t source, std::function<void()> on_written);
+    ///
+    /// \brief Запись потоков группы в течение заданного времени.
+    ///
+    /// \return Число записанных буферов.
+    ///
+    std::size_t record(stream_group& group, std::chrono::milliseconds duration);
+    ///
+    /// \brief Ожидание записи всех поставленных буферов.
+    ///
+    void flush();
+    ///
+    /// \brief Завершение записи: дописывание очереди, усечение сегментов до фактического размера.
+    ///
+    void close();
+    stream_recorder_stats get_stats() const;
+};
+
+class stream_recorder_error : public nebulaxi_error {
+
+public:
+    stream_recorder_error(const std::string&);
+    virtual ~stream_recorder_error() noexcept = default;
+};
+
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "nebulaxi/subsystems/subsystem.hpp"
+
+namespace insys::nebulaxi {
+
+///
+/// \brief Буфер DMA кольца.
+/// \details Память буфера выровнена по странице и не перемещается за время жизни кольца.
+///
+///
+struct dma_buffer {
+    std::byte* data {}; ///< Начало буфера.
+    std::size_t size {}; ///< Емкость буфера в байтах.
+    std::size_t used {}; ///< Число заполненных байтов.
+    uint64_t sequence {}; ///< Порядковый номер заполнения.
+    std::size_t index {}; ///< Индекс буфера в кольце.
+};
+
+///
+/// \brief Статистика кольца DMA.
+///
+///
+struct dma_ring_stats {
+    uint64_t buffers {}; ///< Число заполненных буферов.
+    uint64_t bytes {}; ///< Число переданных байтов.
+    uint64_t producer_stalls {}; ///< Ожидания производителя (нет свободных буферов).
+    uint64_t consumer_stalls {}; ///< Ожидания потребителя (нет заполненных буферов).
+};
+
+///
+/// \brief Кольцо буферов DMA без копирования данных.
+/// \details Один производитель (движок DMA) заполняет свободные буферы, один потребитель получает
+/// заполненные буферы и возвращает их в кольцо. Буферы передаются по указателю, порядок сохраняется.
+///
+class dma_ring final {
+    struct private_data;
+    std::shared_ptr<private_data> d_ptr {};
+
+public:
+    ///
+    /// \brief Конструктор кольца.
+    ///
+    /// \param buffer_size Размер буфера (округляется вверх до размера страницы).
+    /// \param depth Число буферов.
+    ///
+    dma_ring(std::size_t buffer_size, std::size_t depth);
+    dma_ring(const dma_ring&) = delete;
+    dma_ring& operator=(const dma_ring&) = delete;
+    ~dma_ring() noexcept;
+
+    std::size_t buffer_size() const noexcept;
+    std::size_t depth() const noexcept;
+    ///
+    /// \brief Доступ к буферу по индексу (для регистрации буферов в движке DMA).
+    ///
+    dma_buffer& buffer(std::size_t index) const;
+
+    ///
+    /// \brief Получение свободного буфера производителем.
+    ///
+    /// \param timeout Время ожидания.
+    /// \return Буфер или nullptr, если время истекло или кольцо остановлено.
+    ///
+    dma_buffer* acquire_free(std::chrono::microseconds timeout);
+    ///
+    /// \brief Передача заполненного буфера потребителю.
+    ///
+    /// \param buffer Буфер, полученный acquire_free.
+    /// \param used Число заполненных байтов.
+    ///
+    void commit(dma_buffer* buffer, std::size_t used);
+    ///
+    /// \brief Отказ от последнего полученного производителем и не переданного буфера.
+    /// \details Используется при остановке производителя, буфер снова становится свободным.
+    ///
+    /// \param buffer Буфер, полученный последним вызовом acquire_free.
+    ///
+    void abandon(dma_buffer* buffer);
+    ///
+    /// \brief Получение заполненного буфера потребителем.
+    ///
+    /// \param timeout Время ожидания.
+    /// \return Буфер или nullptr, если время истекло или кольцо остановлено и пусто.
+    ///
+    dma_buffer* acquire_filled(std::chrono::microseconds timeout);
+    ///
+    /// \brief Возврат буфера в кольцо.
+    ///
+    /// \param buffer Буфер, полученный acquire_filled.
+    ///
+    void release(dma_buffer* buffer);
+
+    ///
+    /// \brief Остановка кольца, ожидающие вызовы возвращают nullptr.
+    ///
+    void stop() noexcept;
+    bool is_stopped() const noexcept;
+    ///
+    /// \brief Возврат всех буферов в свободное состояние и сброс статистики.
+    /// \details Вызывается, когда ни производитель, ни потребитель не работают с кольцом.
+    ///
+    void reset() noexcept;
+    dma_ring_stats get_stats() const noexcept;
+};
+
+class dma_ring_error : public subsystem_error {
+
+public:
+    dma_ring_error(const std::string&);
+    virtual ~dma_ring_error() noexcept = default;
+};
+
+}
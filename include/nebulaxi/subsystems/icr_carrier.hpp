@@ -1,6 +1,11 @@
 #pragma once
 
+#include <chrono>
 #include <cstddef>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <string>
 #include <vector>
 
 #include "nebulaxi/subsystems/subsystem.hpp"
@@ -9,9 +14,34 @@ namespace insys::nebulaxi {
 
 using icr_raw_data = std::vector<std::byte>;
 
+///
+/// \brief Результат записи ICR.
+///
+///
+struct icr_write_stats {
+    std::size_t words_total {}; ///< Размер микросхемы в словах.
+    std::size_t words_written {}; ///< Число записанных слов.
+    std::chrono::microseconds elapsed {}; ///< Время записи.
+};
+
 struct icr_carrier_interface : virtual subsystem_interface {
     virtual icr_raw_data get_raw_data() const = 0;
     virtual void set_raw_data(const icr_raw_data&) = 0;
+    ///
+    /// \brief Запись ICR с программированием только отличающихся слов.
+    ///
+    /// \param data Новое содержимое ICR (дополняется нулями до размера микросхемы).
+    /// \return Число записанных слов и время записи.
+    ///
+    virtual icr_write_stats update_raw_data(const icr_raw_data& data) = 0;
+    ///
+    /// \brief Асинхронные варианты операций с ICR.
+    /// \details Операции одной платы выполняются последовательно в потоке шины платы,
+    /// операции разных плат выполняются параллельно.
+    ///
+    virtual std::future<icr_raw_data> get_raw_data_async() const = 0;
+    virtual std::future<void> set_raw_data_async(const icr_raw_data&) = 0;
+    virtual std::future<icr_write_stats> update_raw_data_async(const icr_raw_data&) = 0;
 
     virtual std::string get_carrier_name() const noexcept = 0;
     virtual std::string get_carrier_serial() const noexcept = 0;
@@ -23,6 +53,35 @@ struct icr_carrier_interface : virtual subsystem_interface {
 
 using icr_carrier = std::shared_ptr<icr_carrier_interface>;
 
+///
+/// \brief Кэш содержимого ICR.
+/// \details Содержимое ICR запоминается для каждой платы (ключ - шина.слот) в памяти и, если задан каталог,
+/// на диске. Перед использованием кэш сверяется с микросхемой по нескольким словам, при записи ICR сбрасывается.
+///
+class icr_carrier_cache final {
+    struct private_data;
+    static std::shared_ptr<private_data> d_ptr;
+    friend class icr_carrier_impl;
+
+    static bool load(const std::string&, icr_raw_data&);
+    static void store(const std::string&, const icr_raw_data&) noexcept;
+    static void erase(const std::string&) noexcept;
+
+public:
+    ///
+    /// \brief Задание каталога для хранения кэша на диске.
+    ///
+    /// \param directory Каталог, пустой путь отключает кэш на диске.
+    ///
+    static void set_directory(const std::filesystem::path& directory);
+    static std::filesystem::path get_directory();
+    ///
+    /// \brief Очистка кэша в памяти.
+    ///
+    ///
+    static void clear() noexcept;
+};
+
 class icr_carrier_error : public subsystem_error {
 
 public:
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "nebulaxi/subsystems/subsystem.hpp"
+
+namespace insys::nebulaxi {
+
+///
+/// \brief Результат передачи через SDRAM.
+///
+///
+struct sdram_stream_stats {
+    uint64_t bytes {}; ///< Число переданных байтов.
+    std::chrono::microseconds elapsed {}; ///< Время передачи.
+    double bandwidth {}; ///< Достигнутая скорость, байт/с.
+    uint64_t stalls {}; ///< Ожидания хоста на кольце DMA.
+};
+
+///
+/// \brief Подсистема потока через SDRAM платы.
+/// \details SDRAM используется как глубокий буфер: данные загружаются и выгружаются конвейером
+/// через кольцо буферов DMA (пока хост заполняет один буфер, движок передает другой),
+/// входной поток может быть записан в SDRAM и затем выгружен со скоростью хоста.
+///
+/// Сейчас подсистема создается только для симулируемых плат: SDRAM - массив в памяти хоста,
+/// записываемый поток - возрастающие 64-битные слова, а не данные АЦП. Для аппаратной платы
+/// описание подсистемы в конфигурации пропускается с предупреждением в журнале.
+///
+struct sdram_stream_interface : virtual subsystem_interface {
+    ///
+    /// \brief Получение объема SDRAM (для симуляции - из параметра конфигурации).
+    ///
+    /// \return Объем в байтах.
+    ///
+    virtual std::size_t get_capacity() const = 0;
+    ///
+    /// \brief Загрузка данных хоста в SDRAM.
+    ///
+    /// \param data Данные.
+    /// \param size Размер в байтах.
+    /// \param offset Смещение в SDRAM.
+    /// \return Статистика передачи.
+    ///
+    virtual sdram_stream_stats upload(const std::byte* data, std::size_t size, std::size_t offset = 0) = 0;
+    ///
+    /// \brief Выгрузка данных из SDRAM в память хоста.
+    ///
+    virtual sdram_stream_stats download(std::byte* data, std::size_t size, std::size_t offset = 0) = 0;
+    ///
+    /// \brief Выгрузка данных из SDRAM без копирования.
+    ///
+    /// \param consumer Обработчик буферов, буфер действителен только во время вызова.
+    /// \param size Размер в байтах.
+    /// \param offset Смещение в SDRAM.
+    ///
+    virtual sdram_stream_stats drain(const std::function<void(const std::byte*, std::size_t)>& consumer,
+        std::size_t size, std::size_t offset = 0)
+        = 0;
+    ///
+    /// \brief Запуск записи входного потока в SDRAM.
+    ///
+    /// \param size Размер записи в байтах.
+    /// \param offset Смещение в SDRAM.
+    ///
+    virtual void record(std::size_t size, std::size_t offset = 0) = 0;
+    ///
+    /// \brief Ожидание окончания записи.
+    ///
+    /// \return \retval true запись окончена \retval false время истекло.
+    ///
+    virtual bool wait_recorded(std::chrono::milliseconds timeout) = 0;
+    ///
+    /// \brief Статистика последней передачи.
+    /// \details Не ожидает окончания текущей передачи.
+    ///
+    virtual sdram_stream_stats get_stats() const noexcept = 0;
+
+    virtual ~sdram_stream_interface() noexcept = default;
+};
+
+using sdram_stream = std::shared_ptr<sdram_stream_interface>;
+
+class sdram_stream_error : public subsystem_error {
+
+public:
+    sdram_stream_error(const std::string&);
+    virtual ~sdram_stream_error() noexcept = default;
+};
+
+}
@@ -2,9 +2,12 @@
 
 #include <iomanip>
 #include <map>
+#include <mutex>
+#include <shared_mutex>
 #include <sstream>
 #include <string>
 #include <typeindex>
+#include <unordered_map>
 #include <vector>
 
 #include "nebulaxi/nebulaxi_types.hpp"
@@ -35,6 +38,35 @@ namespace detail {
         /// \tparam std::type_index Идентификатор подсистемы
         /// \tparam subsystem Подсистема
         std::multimap<std::type_index, subsystem> map {};
+
+        ///
+        /// \brief Кэш поиска подсистем по базовому интерфейсу.
+        /// \details Хранит результат приведения (или пустой указатель, если подсистемы нет),
+        /// сбрасывается при любом изменении хранилища. Поиск по имени запоминает только найденные
+        /// подсистемы, иначе кэш рос бы на каждое запрошенное имя.
+        /// Поколение увеличивается при сбросе: результат поиска, начатого до сброса, не сохраняется.
+        ///
+        struct base_cache_entry {
+            std::type_index type; ///< Базовый тип подсистемы.
+            std::string name; ///< Имя подсистемы.
+            std::shared_ptr<void> subsystem; ///< Подсистема, приведенная к базовому типу.
+        };
+        std::shared_mutex cache_mutex {};
+        std::unordered_map<std::type_index, std::shared_ptr<void>> base_cache {};
+        std::unordered_multimap<std::size_t, base_cache_entry> named_base_cache {};
+        std::size_t generation {};
+
+        static std::size_t name_hash(std::type_index type, const std::string& name) noexcept
+        {
+            return type.hash_code() ^ std::hash<std::string> {}(name);
+        }
+        void invalidate_cache()
+        {
+            std::unique_lock lock { cache_mutex };
+            base_cache.clear();
+            named_base_cache.clear();
+            ++generation;
+        }
     };
 
 }
@@ -88,6 +120,7 @@ public:
     void add(subsystem_type&& subsystem)
     {
         d_ptr->map.emplace(std::type_index(typeid(subsystem_type)), std::forward<subsystem_type>(subsystem));
+        d_ptr->invalidate_cache();
     }
     ///
     /// \brief Получение подсистемы из хранилища.
@@ -113,12 +146,45 @@ public:
     template <typename base_subsystem_type>
     base_subsystem_type get_base() const
     {
+        auto subsystem = try_get_base<base_subsystem_type>();
+        if (!subsystem) {
+            throw subsystem_storage_error("no subsystem found [" + std::string(typeid(base_subsystem_type).name()) + "]");
+        }
+        return subsystem;
+    }
+    ///
+    /// \brief Получение подсистемы с базовым интерфейсом из хранилища без исключений.
+    /// \details Результат поиска запоминается, повторный вызов - поиск в хэш-таблице.
+    ///
+    /// \tparam base_subsystem_type Базовый тип подсистемы.
+    /// \return Подсистема или пустой указатель, если не найдена.
+    ///
+    template <typename base_subsystem_type>
+    base_subsystem_type try_get_base() const noexcept
+    try {
+        using element_type = typename base_subsystem_type::element_type;
+        const std::type_index type { typeid(base_subsystem_type) };
+        std::size_t generation {};
+        {
+            std::shared_lock lock { d_ptr->cache_mutex };
+            if (auto it = d_ptr->base_cache.find(type); it != d_ptr->base_cache.end()) {
+                return std::static_pointer_cast<element_type>(it->second);
+            }
+            generation = d_ptr->generation;
+        }
+        base_subsystem_type result {};
         for (auto& [type_index, subsystem] : d_ptr->map) {
-            if (subsystem_downcast<base_subsystem_type>(subsystem)) {
-                return subsystem_downcast<base_subsystem_type>(subsystem);
+            if ((result = subsystem_downcast<base_subsystem_type>(subsystem))) {
+                break;
             }
         }
-        throw subsystem_storage_error("no subsystem found [" + std::string(typeid(base_subsystem_type).name()) + "]");
+        std::unique_lock lock { d_ptr->cache_mutex };
+        if (d_ptr->generation == generation) {
+            d_ptr->base_cache.emplace(type, result);
+        }
+        return result;
+    } catch (...) {
+        return {};
     }
     ///
     /// \brief Получение подсистемы из хранилища.
@@ -150,13 +216,53 @@ public:
     template <typename base_subsystem_type>
     base_subsystem_type get_base(const std::string& name) const
     {
+        auto subsystem = try_get_base<base_subsystem_type>(name);
+        if (!subsystem) {
+            throw subsystem_storage_error("no subsystem found [" + name + "]");
+        }
+        return subsystem;
+    }
+    ///
+    /// \brief Получение подсистемы с базовым интерфейсом из хранилища без исключений.
+    /// \details Найденная подсистема запоминается, повторный вызов - поиск в хэш-таблице.
+    ///
+    /// \tparam base_subsystem_type Базовый тип подсистемы.
+    /// \param name Имя подсистемы
+    /// \return Подсистема или пустой указатель, если не найдена.
+    ///
+    template <typename base_subsystem_type>
+    base_subsystem_type try_get_base(const std::string& name) const noexcept
+    try {
+        using element_type = typename base_subsystem_type::element_type;
+        const std::type_index type { typeid(base_subsystem_type) };
+        const auto hash = detail::subsystem_storage_private_data::name_hash(type, name);
+        std::size_t generation {};
+        {
+            std::shared_lock lock { d_ptr->cache_mutex };
+            auto range = d_ptr->named_base_cache.equal_range(hash);
+            for (auto it = range.first; it != range.second; ++it) {
+                if (it->second.type == type && it->second.name == name) {
+                    return std::static_pointer_cast<element_type>(it->second.subsystem);
+                }
+            }
+            generation = d_ptr->generation;
+        }
+        base_subsystem_type result {};
         for (auto& [type_index, subsystem] : d_ptr->map) {
-            if (subsystem_downcast<base_subsystem_type>(subsystem)
-                && subsystem->get_name() == name) {
-                return subsystem_downcast<base_subsystem_type>(subsystem);
+            if (subsystem->get_name() == name && (result = subsystem_downcast<base_subsystem_type>(subsystem))) {
+                break;
             }
         }
-        throw subsystem_storage_error("no subsystem found [" + name + "]");
+        if (!result) {
+            return result;
+        }
+        std::unique_lock lock { d_ptr->cache_mutex };
+        if (d_ptr->generation == generation) {
+            d_ptr->named_base_cache.emplace(hash, detail::subsystem_storage_private_data::base_cache_entry { type, name, result });
+        }
+        return result;
+    } catch (...) {
+        return {};
     }
     ///
     /// \brief Получение подсистемы из хранилища.
@@ -212,6 +318,7 @@ public:
             throw subsystem_storage_error("no subsystem found");
         }
         d_ptr->map.erase(it_subsystem);
+        d_ptr->invalidate_cache();
     }
     ///
     /// \brief Удаление подсистемы из хранилища.
@@ -226,7 +333,8 @@ public:
         for (auto elem = range.first; elem != range.second; ++elem) {
             if (elem->second->get_name() == name) {
                 d_ptr->map.erase(elem);
-                break;
+                d_ptr->invalidate_cache();
+                return;
             }
         }
         throw subsystem_storage_error("no subsystem found [" + name + "]");
@@ -255,12 +363,7 @@ public:
     template <typename base_subsystem_type>
     bool has_base() const noexcept
     {
-        for (auto& [type_index, subsystem] : d_ptr->map) {
-            if (subsystem_downcast<base_subsystem_type>(subsystem)) {
-                return true;
-            }
-        }
-        return false;
+        return try_get_base<base_subsystem_type>() != nullptr;
     }
     ///
     /// \brief Проверка наличия подсистемы в хранилище.
@@ -290,13 +393,7 @@ public:
     template <typename base_subsystem_type>
     bool has_base(const std::string& name) const noexcept
     {
-        for (auto& [type_index, subsystem] : d_ptr->map) {
-            if (subsystem_downcast<base_subsystem_type>(subsystem)
-                && subsystem->get_name() == name) {
-                return true;
-            }
-        }
-        return false;
+        return try_get_base<base_subsystem_type>(name) != nullptr;
     }
     ///
     /// \brief Получение числа подсистем в хранилище.
@@ -317,14 +414,23 @@ public:
     /// \brief Очистка хранилища подсистем.
     ///
     ///
-    void clear() noexcept { d_ptr->map.clear(); }
+    void clear() noexcept
+    {
+        d_ptr->map.clear();
+        d_ptr->invalidate_cache();
+    }
     auto begin() noexcept { return d_ptr->map.begin(); }
     auto end() noexcept { return d_ptr->map.end(); }
     auto begin() const noexcept { return d_ptr->map.begin(); }
     auto end() const noexcept { return d_ptr->map.end(); }
     auto cbegin() const noexcept { return d_ptr->map.cbegin(); }
     auto cend() const noexcept { return d_ptr->map.cend(); }
-    void merge(const subsystem_storage& other) noexcept { d_ptr->map.merge(other.d_ptr->map); }
+    void merge(const subsystem_storage& other) noexcept
+    {
+        d_ptr->map.merge(other.d_ptr->map);
+        d_ptr->invalidate_cache();
+        other.d_ptr->invalidate_cache();
+    }
 };
 
 }
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <chrono>
+#include <vector>
+
 #include "nebulaxi/units/unit.hpp"
 
 namespace insys::nebulaxi {
@@ -28,6 +31,26 @@ struct sysmon_nominals {
     double vref_n; ///< Опорное напряжение "-".
 };
 
+///
+/// \brief Снимок всех каналов системного монитора.
+///
+///
+struct sysmon_snapshot {
+    std::chrono::steady_clock::time_point timestamp; ///< Время чтения (монотонные часы).
+    sysmon_value temperature; ///< Температура кристалла.
+    sysmon_value vcc_int; ///< Напряжение питания ядра.
+    sysmon_value vcc_aux; ///< Напряжение питания ПЛИС.
+    sysmon_value vcc_bram; ///< Напряжение питания блока памяти.
+    double vref_p; ///< Опорное напряжение "+".
+    double vref_n; ///< Опорное напряжение "-".
+};
+
+///
+/// \brief История снимков системного монитора (от старых к новым).
+///
+///
+using sysmon_history = std::vector<sysmon_snapshot>;
+
 ///
 /// \brief Интерфейс подсистемы системного монитора.
 ///
@@ -80,6 +103,38 @@ struct sysmon_interface : virtual unit_interface {
     /// \return Опорное напряжение.
     ///
     virtual double get_vref_n() const = 0;
+    ///
+    /// \brief Запуск фонового опроса всех каналов.
+    /// \details Снимки публикуются в кольцевой буфер истории, чтение истории не обращается к шине.
+    ///
+    /// \param period Период опроса.
+    ///
+    virtual void start_sampling(std::chrono::milliseconds period) = 0;
+    ///
+    /// \brief Остановка фонового опроса.
+    ///
+    ///
+    virtual void stop_sampling() noexcept = 0;
+    ///
+    /// \brief Проверка состояния фонового опроса.
+    ///
+    /// \return \retval true опрос запущен \retval false опрос остановлен.
+    ///
+    virtual bool is_sampling() const noexcept = 0;
+    ///
+    /// \brief Получение последнего снимка фонового опроса.
+    ///
+    /// \param[out] snapshot Снимок.
+    /// \return \retval true снимок получен \retval false снимков еще нет.
+    ///
+    virtual bool get_snapshot(sysmon_snapshot& snapshot) const noexcept = 0;
+    ///
+    /// \brief Получение снимков фонового опроса за интервал времени.
+    ///
+    /// \param window Интервал от текущего момента.
+    /// \return Снимки, попавшие в интервал.
+    ///
+    virtual sysmon_history get_history(std::chrono::milliseconds window) const = 0;
 
     ///
     /// \brief Деструктор подсистемы системный монитор.
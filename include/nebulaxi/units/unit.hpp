@@ -1,12 +1,44 @@
 #pragma once
 
+#include <array>
+#include <chrono>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "nebulaxi/nebulaxi_error.hpp"
 
 namespace insys::nebulaxi {
 
+///
+/// \brief Счетчики кэша регистров юнита.
+///
+///
+struct reg_cache_stats {
+    std::size_t hits {}; ///< Чтения, обслуженные из кэша.
+    std::size_t misses {}; ///< Чтения кэшируемых регистров с шины.
+};
+
+/// Число интервалов гистограммы задержек обращений к регистрам.
+inline constexpr std::size_t reg_latency_buckets { 32 };
+
+///
+/// \brief Счетчики обращений к регистру юнита по шине.
+/// \details Интервал latency[i] содержит обращения длительностью [2^(i-1), 2^i) нс,
+/// latency[0] - короче 1 нс, последний интервал - все более долгие.
+///
+struct reg_access_stats {
+    std::size_t offset {}; ///< Смещение регистра, SIZE_MAX - регистры, не поместившиеся в таблицу.
+    uint64_t reads {}; ///< Число чтений.
+    uint64_t writes {}; ///< Число записей.
+    std::chrono::nanoseconds read_time {}; ///< Суммарное время чтений.
+    std::chrono::nanoseconds write_time {}; ///< Суммарное время записей.
+    std::array<uint64_t, reg_latency_buckets> latency {}; ///< Гистограмма задержек.
+};
+
+using reg_access_stats_list = std::vector<reg_access_stats>;
+
 ///
 /// \brief Родительский класс для всех производных юнитов.
 ///
@@ -37,6 +69,34 @@ struct unit_interface {
     ///
     virtual std::string get_info() const noexcept = 0;
     ///
+    /// \brief Получение счетчиков кэша регистров.
+    ///
+    /// \return Число попаданий и промахов.
+    ///
+    virtual reg_cache_stats get_reg_cache_stats() const noexcept = 0;
+    ///
+    /// \brief Сброс кэша регистров, например после сброса юнита.
+    ///
+    ///
+    virtual void reg_cache_invalidate() = 0;
+    ///
+    /// \brief Перечитывание кэшируемых регистров с шины.
+    ///
+    ///
+    virtual void reg_cache_resync() = 0;
+    ///
+    /// \brief Получение счетчиков обращений к регистрам.
+    /// \details Счетчики ведутся, если библиотека собрана с NEBULAXI_REG_STATS, иначе список пуст.
+    ///
+    /// \return Счетчики по регистрам, к которым были обращения, по возрастанию смещений.
+    ///
+    virtual reg_access_stats_list get_reg_access_stats() const = 0;
+    ///
+    /// \brief Сброс счетчиков обращений к регистрам.
+    ///
+    ///
+    virtual void reg_access_stats_reset() noexcept = 0;
+    ///
     /// \brief Деструктор юнита.
     ///
     ///
@@ -1,10 +1,12 @@
 #pragma once
 
+#include <cctype>
 #include <iomanip>
 #include <map>
 #include <sstream>
 #include <string>
 #include <typeindex>
+#include <unordered_map>
 #include <vector>
 
 #include "nebulaxi/nebulaxi_types.hpp"
@@ -36,6 +38,102 @@ namespace detail {
         /// \tparam std::type_index Идентификатор юнита
         /// \tparam unit Юнит
         std::multimap<std::type_index, unit> map {};
+
+        ///
+        /// \brief Элемент индекса юнитов.
+        /// \details Юнит хранится уже приведенным к типу, под которым он добавлен,
+        /// поэтому поиск не требует dynamic_pointer_cast и копирования имени.
+        ///
+        struct index_entry {
+            std::type_index type; ///< Тип юнита.
+            std::size_t offset; ///< Смещение юнита.
+            std::string name; ///< Имя юнита.
+            std::shared_ptr<void> unit; ///< Юнит, приведенный к своему типу.
+        };
+        std::vector<index_entry> entries {};
+        std::unordered_map<std::type_index, std::size_t> by_type {};
+        std::unordered_multimap<std::size_t, std::size_t> by_name {};
+        std::unordered_multimap<std::size_t, std::size_t> by_offset {};
+
+        /// Хэш имени без учета регистра (как и поиск по имени).
+        static std::size_t name_hash(std::type_index type, const std::string& name) noexcept
+        {
+            std::size_t hash { type.hash_code() };
+            for (unsigned char ch : name) {
+                hash = (hash ^ std::size_t(std::tolower(ch))) * 1099511628211ull;
+            }
+            return hash;
+        }
+        static std::size_t offset_hash(std::type_index type, std::size_t offset) noexcept
+        {
+            return type.hash_code() ^ (offset * 0x9E3779B97F4A7C15ull);
+        }
+        /// Сравнение имени юнита с искомым именем, приведенным к нижнему регистру.
+        static bool name_equal(const std::string& name, const std::string& query) noexcept
+        {
+            if (name.size() != query.size()) {
+                return false;
+            }
+            for (std::size_t pos {}; pos < name.size(); ++pos) {
+                if (name[pos] != char(std::tolower(static_cast<unsigned char>(query[pos])))) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        void index(std::size_t position)
+        {
+            auto& entry = entries[position];
+            by_type.emplace(entry.type, position);
+            by_name.emplace(name_hash(entry.type, entry.name), position);
+            by_offset.emplace(offset_hash(entry.type, entry.offset), position);
+        }
+        void rebuild_index()
+        {
+            by_type.clear();
+            by_name.clear();
+            by_offset.clear();
+            for (std::size_t position {}; position < entries.size(); ++position) {
+                index(position);
+            }
+        }
+        void erase_entry(const unit& unit)
+        {
+            for (auto it = entries.begin(); it != entries.end(); ++it) {
+                if (!it->unit.owner_before(unit) && !unit.owner_before(it->unit)) {
+                    entries.erase(it);
+                    break;
+                }
+            }
+            rebuild_index();
+        }
+        const index_entry* find(std::type_index type) const noexcept
+        {
+            auto it = by_type.find(type);
+            return it == by_type.end() ? nullptr : &entries[it->second];
+        }
+        const index_entry* find(std::type_index type, const std::string& name) const noexcept
+        {
+            auto range = by_name.equal_range(name_hash(type, name));
+            for (auto it = range.first; it != range.second; ++it) {
+                auto& entry = entries[it->second];
+                if (entry.type == type && name_equal(entry.name, name)) {
+                    return &entry;
+                }
+            }
+            return nullptr;
+        }
+        const index_entry* find(std::type_index type, std::size_t offset) const noexcept
+        {
+            auto range = by_offset.equal_range(offset_hash(type, offset));
+            for (auto it = range.first; it != range.second; ++it) {
+                auto& entry = entries[it->second];
+                if (entry.type == type && entry.offset == offset) {
+                    return &entry;
+                }
+            }
+            return nullptr;
+        }
     };
 
 }
@@ -52,17 +150,13 @@ class unit_storage final {
         std::make_shared<detail::unit_storage_private_data>()
     };
     ///
-    /// \brief Приведение типа от родительского юнита к унаследованному.
+    /// \brief Получение юнита из элемента индекса.
+    /// \details Юнит в индексе уже приведен к типу unit_type, поэтому достаточно static_pointer_cast.
     ///
-    /// \tparam derrived_type Тип унаследованной юнита.
-    /// \tparam base_type Тип родительской подситемы.
-    /// \param base Универсальная ссылка на родительский юнит.
-    /// \return auto Умный указатель на унаследованный юнит.
-    ///
-    template <typename derrived_type, typename base_type = unit>
-    auto unit_downcast(base_type&& base) const
+    template <typename unit_type>
+    static unit_type unit_from_entry(const detail::unit_storage_private_data::index_entry& entry) noexcept
     {
-        return std::dynamic_pointer_cast<typename derrived_type::element_type>(base);
+        return std::static_pointer_cast<typename unit_type::element_type>(entry.unit);
     }
 
 public:
@@ -87,7 +181,13 @@ public:
     template <typename unit_type>
     void add(unit_type&& unit)
     {
+        std::shared_ptr<void> typed_unit { unit };
+        detail::unit_storage_private_data::index_entry entry {
+            std::type_index(typeid(unit_type)), unit->get_offset(), unit->get_name(), std::move(typed_unit)
+        };
         d_ptr->map.emplace(std::type_index(typeid(unit_type)), std::forward<unit_type>(unit));
+        d_ptr->entries.push_back(std::move(entry));
+        d_ptr->index(d_ptr->entries.size() - 1);
     }
     ///
     /// \brief Получение юнита из хранилища.
@@ -98,11 +198,11 @@ public:
     template <typename unit_type>
     unit_type get() const
     {
-        auto it_unit = d_ptr->map.find(std::type_index(typeid(unit_type)));
-        if (it_unit == d_ptr->map.end()) {
+        auto entry = d_ptr->find(std::type_index(typeid(unit_type)));
+        if (!entry) {
             throw unit_storage_error("no unit found [" + std::string(typeid(unit_type).name()) + "]");
         }
-        return unit_downcast<unit_type>(it_unit->second);
+        return unit_from_entry<unit_type>(*entry);
     }
     ///
     /// \brief Получение юнита из хранилища.
@@ -114,15 +214,13 @@ public:
     template <typename unit_type>
     unit_type get(std::size_t unit_offset) const
     {
-        auto range = d_ptr->map.equal_range(std::type_index(typeid(unit_type)));
-        for (auto elem = range.first; elem != range.second; ++elem) {
-            if (elem->second->get_offset() == unit_offset) {
-                return unit_downcast<unit_type>(elem->second);
-            }
+        auto entry = d_ptr->find(std::type_index(typeid(unit_type)), unit_offset);
+        if (!entry) {
+            std::stringstream hex_str;
+            hex_str << std::showbase << std::hex << unit_offset;
+            throw unit_storage_error("no unit found [" + hex_str.str() + "]");
         }
-        std::stringstream hex_str;
-        hex_str << std::showbase << std::hex << unit_offset;
-        throw unit_storage_error("no unit found [" + hex_str.str() + "]");
+        return unit_from_entry<unit_type>(*entry);
     }
     ///
     /// \brief Получение юнита из хранилища.
@@ -135,14 +233,11 @@ public:
     template <typename unit_type>
     unit_type get(const std::string& name) const
     {
-        std::string _name = to_lowercase_string(name);
-        auto range = d_ptr->map.equal_range(std::type_index(typeid(unit_type)));
-        for (auto elem = range.first; elem != range.second; ++elem) {
-            if (elem->second->get_name() == _name) {
-                return unit_downcast<unit_type>(elem->second);
-            }
+        auto entry = d_ptr->find(std::type_index(typeid(unit_type)), name);
+        if (!entry) {
+            throw unit_storage_error("no unit found [" + to_lowercase_string(name) + "]");
         }
-        throw unit_storage_error("no unit found [" + _name + "]");
+        return unit_from_entry<unit_type>(*entry);
     }
     ///
     /// \brief Получение юнита из хранилища.
@@ -153,15 +248,13 @@ public:
     ///
     template <typename unit_type>
     bool get(unit_type& unit) const noexcept
-    try {
-        auto it_unit = d_ptr->map.find(std::type_index(typeid(unit_type)));
-        if (it_unit == d_ptr->map.end()) {
+    {
+        auto entry = d_ptr->find(std::type_index(typeid(unit_type)));
+        if (!entry) {
             return false;
         }
-        unit = unit_downcast<unit_type>(it_unit->second);
+        unit = unit_from_entry<unit_type>(*entry);
         return true;
-    } catch (...) {
-        return false;
     }
     ///
     /// \brief Получение юнита из хранилища.
@@ -173,17 +266,13 @@ public:
     ///
     template <typename unit_type>
     bool get(unit_type& unit, std::size_t unit_offset) const noexcept
-    try {
-        auto range = d_ptr->map.equal_range(std::type_index(typeid(unit_type)));
-        for (auto elem = range.first; elem != range.second; ++elem) {
-            if (elem->second->get_offset() == unit_offset) {
-                unit = unit_downcast<unit_type>(elem->second);
-                return true;
-            }
+    {
+        auto entry = d_ptr->find(std::type_index(typeid(unit_type)), unit_offset);
+        if (!entry) {
+            return false;
         }
-        return false;
-    } catch (...) {
-        return false;
+        unit = unit_from_entry<unit_type>(*entry);
+        return true;
     }
     ///
     /// \brief Получение юнита из хранилища.
@@ -195,18 +284,13 @@ public:
     ///
     template <typename unit_type>
     bool get(unit_type& unit, const std::string& name) const noexcept
-    try {
-        std::string _name = to_lowercase_string(name);
-        auto range = d_ptr->map.equal_range(std::type_index(typeid(unit_type)));
-        for (auto elem = range.first; elem != range.second; ++elem) {
-            if (elem->second->get_name() == _name) {
-                unit = unit_downcast<unit_type>(elem->second);
-                return true;
-            }
+    {
+        auto entry = d_ptr->find(std::type_index(typeid(unit_type)), name);
+        if (!entry) {
+            return false;
         }
-        return false;
-    } catch (...) {
-        return false;
+        unit = unit_from_entry<unit_type>(*entry);
+        return true;
     }
     ///
     /// \brief Удаление юнита из хранилища.
@@ -220,6 +304,7 @@ public:
         if (it_unit == d_ptr->map.end()) {
             throw unit_storage_error("no unit found [" + std::string(typeid(unit_type).name()) + "]");
         }
+        d_ptr->erase_entry(it_unit->second);
         d_ptr->map.erase(it_unit);
     }
     ///
@@ -234,8 +319,9 @@ public:
         auto range = d_ptr->map.equal_range(std::type_index(typeid(unit_type)));
         for (auto elem = range.first; elem != range.second; ++elem) {
             if (elem->second->get_offset() == unit_offset) {
+                d_ptr->erase_entry(elem->second);
                 d_ptr->map.erase(elem);
-                break;
+                return;
             }
         }
         std::stringstream hex_str;
@@ -255,8 +341,9 @@ public:
         auto range = d_ptr->map.equal_range(std::type_index(typeid(unit_type)));
         for (auto elem = range.first; elem != range.second; ++elem) {
             if (elem->second->get_name() == _name) {
+                d_ptr->erase_entry(elem->second);
                 d_ptr->map.erase(elem);
-                break;
+                return;
             }
         }
         throw unit_storage_error("no unit found [" + _name + "]");
@@ -270,11 +357,7 @@ public:
     template <typename unit_type>
     bool has_unit() const noexcept
     {
-        auto it_unit = d_ptr->map.find(std::type_index(typeid(unit_type)));
-        if (it_unit == d_ptr->map.end()) {
-            return false;
-        }
-        return true;
+        return d_ptr->find(std::type_index(typeid(unit_type))) != nullptr;
     }
     ///
     /// \brief Проверка наличия юнита в хранилище.
@@ -286,13 +369,7 @@ public:
     template <typename unit_type>
     bool has_unit(std::size_t unit_offset) const noexcept
     {
-        auto range = d_ptr->map.equal_range(std::type_index(typeid(unit_type)));
-        for (auto elem = range.first; elem != range.second; ++elem) {
-            if (elem->second->get_offset() == unit_offset) {
-                return true;
-            }
-        }
-        return false;
+        return d_ptr->find(std::type_index(typeid(unit_type)), unit_offset) != nullptr;
     }
     ///
     /// \brief Проверка наличия юнита в хранилище.
@@ -304,14 +381,7 @@ public:
     template <typename unit_type>
     bool has_unit(const std::string& name) const noexcept
     {
-        std::string _name = to_lowercase_string(name);
-        auto range = d_ptr->map.equal_range(std::type_index(typeid(unit_type)));
-        for (auto elem = range.first; elem != range.second; ++elem) {
-            if (elem->second->get_name() == _name) {
-                return true;
-            }
-        }
-        return false;
+        return d_ptr->find(std::type_index(typeid(unit_type)), name) != nullptr;
     }
     ///
     /// \brief Получение числа юнитов в хранилище.
@@ -332,14 +402,31 @@ public:
     /// \brief Очистка хранилища юнитов.
     ///
     ///
-    void clear() noexcept { d_ptr->map.clear(); }
+    void clear() noexcept
+    {
+        d_ptr->map.clear();
+        d_ptr->entries.clear();
+        d_ptr->rebuild_index();
+    }
     auto begin() noexcept { return d_ptr->map.begin(); }
     auto end() noexcept { return d_ptr->map.end(); }
     auto begin() const noexcept { return d_ptr->map.begin(); }
     auto end() const noexcept { return d_ptr->map.end(); }
     auto cbegin() const noexcept { return d_ptr->map.cbegin(); }
     auto cend() const noexcept { return d_ptr->map.cend(); }
-    void merge(const unit_storage& other) noexcept { d_ptr->map.merge(other.d_ptr->map); }
+    void merge(const unit_storage& other) noexcept
+    {
+        if (d_ptr == other.d_ptr) {
+            return;
+        }
+        d_ptr->map.merge(other.d_ptr->map);
+        for (auto& entry : other.d_ptr->entries) {
+            d_ptr->entries.push_back(std::move(entry));
+            d_ptr->index(d_ptr->entries.size() - 1);
+        }
+        other.d_ptr->entries.clear();
+        other.d_ptr->rebuild_index();
+    }
 };
 
 }
@@ -0,0 +1,93 @@
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include "bus_executor.hxx"
+
+using namespace insys::nebulaxi;
+
+struct bus_executor::private_data {
+    std::string name {};
+    std::mutex mutex {};
+    std::condition_variable wakeup {};
+    std::deque<std::function<void()>> queue {};
+    bool running { true };
+    std::thread thread {};
+};
+
+bus_executor::bus_executor(const std::string& name)
+    : d_ptr { std::make_shared<private_data>() }
+{
+    d_ptr->name = name;
+    d_ptr->thread = std::thread([data = d_ptr] {
+        std::unique_lock lock { data->mutex };
+        for (;;) {
+            data->wakeup.wait(lock, [data] { return !data->running || !data->queue.empty(); });
+            if (data->queue.empty()) {
+                return;
+            }
+            auto task = std::move(data->queue.front());
+            data->queue.pop_front();
+            lock.unlock();
+            task();
+            lock.lock();
+        }
+    });
+}
+
+bus_executor::~bus_executor() noexcept
+{
+    {
+        std::lock_guard lock { d_ptr->mutex };
+        d_ptr->running = false;
+    }
+    d_ptr->wakeup.notify_one();
+    if (d_ptr->thread.get_id() == std::this_thread::get_id()) {
+        // последняя ссылка освобождена задачей самого исполнителя
+        d_ptr->thread.detach();
+        return;
+    }
+    d_ptr->thread.join();
+}
+
+void bus_executor::post(std::function<void()> task) const
+{
+    {
+        std::lock_guard lock { d_ptr->mutex };
+        d_ptr->queue.push_back(std::move(task));
+    }
+    d_ptr->wakeup.notify_one();
+}
+
+void bus_executor::wait() const
+{
+    submit([] {}).wait();
+}
+
+bool bus_executor::is_current() const noexcept
+{
+    return d_ptr->thread.get_id() == std::this_thread::get_id();
+}
+
+std::string bus_executor::get_name() const noexcept
+{
+    return d_ptr->name;
+}
+
+std::shared_ptr<bus_executor> bus_executor::get(const std::string& name)
+{
+    static std::mutex mutex {};
+    static std::map<std::string, std::weak_ptr<bus_executor>> executors {};
+    std::lock_guard lock { mutex };
+    if (auto executor = executors[name].lock()) {
+        return executor;
+    }
+    for (auto it = executors.begin(); it != executors.end();) {
+        it = it->second.expired() ? executors.erase(it) : std::next(it);
+    }
+    auto executor = std::make_shared<bus_executor>(name);
+    executors[name] = executor;
+    return executor;
+}
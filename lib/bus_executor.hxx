@@ -0,0 +1,66 @@
+#pragma once
+
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+namespace insys::nebulaxi {
+
+///
+/// \brief Последовательный исполнитель транзакций шины.
+/// \details Задачи выполняются в отдельном потоке строго в порядке постановки, поэтому
+/// транзакции одной шины не перемешиваются, а транзакции разных шин идут параллельно.
+/// Ожидать результат задачи из задачи того же исполнителя нельзя.
+/// Через исполнитель выполняются только обращения к ICR носителя (icr_carrier); юниты SPI/I2C
+/// и драйверы микросхем к нему не подключены.
+///
+class bus_executor final {
+    struct private_data;
+    std::shared_ptr<private_data> d_ptr {};
+
+    void post(std::function<void()> task) const;
+
+public:
+    explicit bus_executor(const std::string& name);
+    bus_executor(const bus_executor&) = delete;
+    bus_executor& operator=(const bus_executor&) = delete;
+    ///
+    /// \brief Деструктор, выполняет оставшиеся задачи и останавливает поток.
+    ///
+    ~bus_executor() noexcept;
+    ///
+    /// \brief Постановка задачи в очередь.
+    ///
+    /// \param function Задача.
+    /// \return Результат задачи (исключение задачи передается через future).
+    ///
+    template <typename function_type>
+    auto submit(function_type&& function) const
+    {
+        using result_type = std::invoke_result_t<std::decay_t<function_type>>;
+        auto task = std::make_shared<std::packaged_task<result_type()>>(std::forward<function_type>(function));
+        auto result = task->get_future();
+        post([task] { (*task)(); });
+        return result;
+    }
+    ///
+    /// \brief Ожидание выполнения всех поставленных задач.
+    ///
+    void wait() const;
+    ///
+    /// \brief Проверка, что вызов выполняется задачей этого исполнителя.
+    ///
+    bool is_current() const noexcept;
+    std::string get_name() const noexcept;
+    ///
+    /// \brief Получение исполнителя шины по имени.
+    /// \details Исполнитель общий для всех владельцев и существует, пока на него есть ссылки.
+    ///
+    /// \param name Имя шины.
+    ///
+    static std::shared_ptr<bus_executor> get(const std::string& name);
+};
+
+}
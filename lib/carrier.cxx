@@ -2,6 +2,7 @@
 
 #include "carrier.hxx"
 #include "carrier_builder.hxx"
+#include "carrier_config.hxx"
 #include "io/io.hxx"
 
 using namespace std::string_literals;
@@ -32,21 +33,17 @@ carrier_impl::carrier_impl(io_type type, std::size_t index)
     d_ptr->log = logger::create_log(logger_name);
     d_ptr->io = io_impl::create(type, index);
     auto location = d_ptr->io->get_location();
-    ::config_parser config_parser {};
     auto device_id = d_ptr->io->get_board_info().device_id;
-    if (auto filename = config_parser::get_carrier_filename(device_id);
-        config_parser::is_file_exist(filename)) {
-        config_parser = ::config_parser { filename };
-        d_ptr->log->debug("parsing configuration file: {}", filename.string());
-    } else {
+    auto config = carrier_config_cache::get(device_id);
+    if (!config) {
         d_ptr->log->warn("configuration file not found");
         d_ptr->log->debug("carrier created");
         return;
     }
-    ::carrier_parser carrier_parser { config_parser.get_carrier() };
+    d_ptr->log->debug("using configuration file: {}", config->filename.string());
     ::carrier_builder carrier_builder(d_ptr->io);
-    carrier_builder.build_units_chips(carrier_parser.get_units());
-    carrier_builder.build_subsystems(carrier_parser.get_subsystems());
+    carrier_builder.build_units_chips(config->units);
+    carrier_builder.build_subsystems(config->subsystems);
     d_ptr->subsystems = carrier_builder.get_subsystems();
     auto icr_carrier = d_ptr->subsystems.get<::icr_carrier>();
     auto version = icr_carrier->get_carrier_version();
@@ -60,7 +57,7 @@ carrier_impl::carrier_impl(io_type type, std::size_t index)
     d_ptr->chips = carrier_builder.get_chips();
     d_ptr->units = carrier_builder.get_units();
     d_ptr->storage = carrier_builder.get_storage();
-    d_ptr->name = carrier_parser.get_name();
+    d_ptr->name = config->name;
     d_ptr->log->debug("carrier created");
 }
 carrier_impl::~carrier_impl() noexcept
@@ -117,6 +114,25 @@ std::string carrier_impl::get_serial() const noexcept
     return d_ptr->serial;
 }
 
+unit_reg_access_stats_list carrier_impl::get_reg_access_stats() const
+{
+    unit_reg_access_stats_list list {};
+    for (auto& [type, unit] : d_ptr->units) {
+        auto regs = unit->get_reg_access_stats();
+        if (!regs.empty()) {
+            list.push_back({ unit->get_name(), unit->get_offset(), std::move(regs) });
+        }
+    }
+    return list;
+}
+
+void carrier_impl::reg_access_stats_reset() noexcept
+{
+    for (auto& [type, unit] : d_ptr->units) {
+        unit->reg_access_stats_reset();
+    }
+}
+
 carrier carrier_creator::create(io_type type, std::size_t index)
 {
     return std::make_shared<carrier_impl>(type, index);
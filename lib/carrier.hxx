@@ -23,6 +23,8 @@ private:
     const subsystem_storage& subsystems() const noexcept final;
     const unit_storage& units() const noexcept final;
     const chip_storage& chips() const noexcept final;
+    unit_reg_access_stats_list get_reg_access_stats() const final;
+    void reg_access_stats_reset() noexcept final;
 
     data_storage& storage() const noexcept;
 };
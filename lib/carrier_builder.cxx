@@ -4,6 +4,7 @@
 #include "subsystems/icr_carrier.hxx"
 #include "subsystems/main_stream.hxx"
 #include "subsystems/power.hxx"
+#include "subsystems/sdram_stream.hxx"
 #include "units/sysmon.hxx"
 
 using namespace insys::nebulaxi;
@@ -28,6 +29,7 @@ void carrier_builder::build_units_chips(const config_tree& units_tree)
         data.offset = parser.get_offset();
         data.name = parser.get_name();
         data.info = parser.get_info();
+        data.reg_cache = parser.get_reg_cache();
         if (sysmon_impl::is_same_type(type)) {
             add_unit<sysmon_impl, sysmon_parser>(data, sysmon_parser { unit_node });
         }
@@ -57,16 +59,26 @@ carrier_builder::add_subsystem(const std::string& type, const subsystem_data& da
 
 void carrier_builder::build_subsystems(const config_tree& subsystem_tree)
 {
+    auto carrier_location = _io->get_location();
+    DATA_STORAGE_ADD_VALUE(_storage, carrier_location);
     subsystem_data data { _storage, _units, _chips, {}, {} };
     for (auto& [str, subsystem_node] : subsystem_tree) {
         subsystem_parser parser { subsystem_node };
         auto type = parser.get_type();
         data.name = parser.get_name();
         data.info = parser.get_info();
+        if (sdram_stream_impl::is_same_type(type) && !_io->is_simulate()) {
+            // для аппаратной платы нет драйвера контроллера SDRAM, только программная модель
+            auto log = logger::create_log("carrier_builder");
+            log->warn("subsystem {} [{}] skipped: sdram_stream is supported on simulate boards only", data.name, data.info);
+            logger::drop_log(log);
+            continue;
+        }
         add_subsystem<icr_carrier_impl>(type, data, icr_carrier_parser { parser() })
             || add_subsystem<clock_base_impl>(type, data, clock_base_parser { parser() })
             || add_subsystem<power_impl>(type, data, power_parser { parser() })
             || add_subsystem<main_stream_impl>(type, data, main_stream_parser { parser() })
+            || add_subsystem<sdram_stream_impl>(type, data, sdram_stream_parser { parser() })
             // TODO: добавлять по или
             || false;
     }
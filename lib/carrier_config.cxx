@@ -0,0 +1,89 @@
+#include <future>
+#include <map>
+#include <mutex>
+
+#include "carrier.hxx"
+#include "carrier_config.hxx"
+
+using namespace insys::nebulaxi;
+
+struct carrier_config_cache::private_data {
+    ///
+    /// \brief Разбор файла, выполняемый одним из потоков.
+    ///
+    struct parsing {
+        std::filesystem::path filename {};
+        std::filesystem::file_time_type modified {};
+        std::shared_future<carrier_config_ptr> result {};
+    };
+    std::mutex mutex {};
+    std::map<device_id_type, carrier_config_ptr> configs {};
+    std::map<device_id_type, parsing> in_flight {}; ///< Разбираемые сейчас файлы.
+};
+
+std::shared_ptr<carrier_config_cache::private_data> carrier_config_cache::d_ptr {
+    std::make_shared<carrier_config_cache::private_data>()
+};
+
+carrier_config_ptr carrier_config_cache::get(device_id_type device_id)
+{
+    auto filename = config_parser::get_carrier_filename(device_id);
+    std::error_code error {};
+    auto exist = config_parser::is_file_exist(filename);
+    auto modified = exist ? std::filesystem::last_write_time(filename, error) : std::filesystem::file_time_type {};
+    if (!exist || error) {
+        // файл удален или недоступен
+        std::lock_guard lock { d_ptr->mutex };
+        d_ptr->configs.erase(device_id);
+        return {};
+    }
+    std::promise<carrier_config_ptr> promise {};
+    {
+        std::unique_lock lock { d_ptr->mutex };
+        if (auto it = d_ptr->configs.find(device_id); it != d_ptr->configs.end()
+            && it->second->filename == filename && it->second->modified == modified) {
+            return it->second;
+        }
+        // тот же файл уже разбирается другим потоком (параллельный поиск одинаковых плат)
+        if (auto it = d_ptr->in_flight.find(device_id); it != d_ptr->in_flight.end()
+            && it->second.filename == filename && it->second.modified == modified) {
+            auto result = it->second.result;
+            lock.unlock();
+            return result.get();
+        }
+        d_ptr->in_flight[device_id] = { filename, modified, promise.get_future().share() };
+    }
+    // разбор файла выполняется без блокировки, чтобы не задерживать получение других конфигураций
+    auto finish = [&](carrier_config_ptr config) {
+        std::lock_guard lock { d_ptr->mutex };
+        if (auto it = d_ptr->in_flight.find(device_id); it != d_ptr->in_flight.end()
+            && it->second.filename == filename && it->second.modified == modified) {
+            d_ptr->in_flight.erase(it);
+        }
+        if (config) {
+            d_ptr->configs[device_id] = config;
+        }
+    };
+    try {
+        ::carrier_parser carrier_parser { ::config_parser { filename }.get_carrier() };
+        auto config = std::make_shared<carrier_config>();
+        config->filename = filename;
+        config->modified = modified;
+        config->name = carrier_parser.get_name();
+        config->units = carrier_parser.get_units();
+        config->subsystems = carrier_parser.get_subsystems();
+        finish(config);
+        promise.set_value(config);
+        return config;
+    } catch (...) {
+        finish({});
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+}
+
+void carrier_config_cache::clear() noexcept
+{
+    std::lock_guard lock { d_ptr->mutex };
+    d_ptr->configs.clear();
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#include "nebulaxi/io/io.hpp"
+
+#include "config_parser.hxx"
+
+namespace insys::nebulaxi {
+
+///
+/// \brief Разобранная конфигурация носителя.
+/// \details Общая для всех носителей одной модели, после создания не изменяется.
+///
+///
+struct carrier_config {
+    std::filesystem::path filename {}; ///< Файл конфигурации.
+    std::filesystem::file_time_type modified {}; ///< Время изменения файла на момент разбора.
+    std::string name {}; ///< Имя носителя.
+    config_tree units {}; ///< Описание юнитов.
+    config_tree subsystems {}; ///< Описание подсистем.
+};
+
+using carrier_config_ptr = std::shared_ptr<const carrier_config>;
+
+///
+/// \brief Кэш конфигураций носителей.
+/// \details Файл конфигурации разбирается один раз для каждого device_id и повторно только при изменении файла.
+///
+///
+class carrier_config_cache final {
+    struct private_data;
+    static std::shared_ptr<private_data> d_ptr;
+
+public:
+    using device_id_type = decltype(io_info::device_id);
+    ///
+    /// \brief Получение конфигурации носителя.
+    ///
+    /// \param device_id Идентификатор устройства.
+    /// \return Конфигурация или nullptr, если файл конфигурации не найден.
+    ///
+    static carrier_config_ptr get(device_id_type device_id);
+    ///
+    /// \brief Очистка кэша.
+    ///
+    ///
+    static void clear() noexcept;
+};
+
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace insys::nebulaxi {
+
+///
+/// \brief Кольцевой буфер истории значений без блокировок.
+/// \details Один писатель и произвольное число читателей. Каждая ячейка защищена счетчиком
+/// последовательности (seqlock): читатель повторяет чтение, если ячейку перезаписали во время копирования.
+///
+/// \tparam value_type Тип хранимого значения (должен быть тривиально копируемым).
+/// \tparam capacity_value Емкость буфера (степень двойки).
+///
+template <typename value_type, std::size_t capacity_value>
+class history_ring final {
+    static_assert(std::is_trivially_copyable_v<value_type>, "value type must be trivially copyable");
+    static_assert(capacity_value && !(capacity_value & (capacity_value - 1)), "capacity must be a power of two");
+
+    struct slot {
+        std::atomic<uint64_t> sequence {}; ///< Нечетное значение - идет запись.
+        value_type value {};
+    };
+    std::array<slot, capacity_value> _slots {};
+    std::atomic<uint64_t> _head {}; ///< Число опубликованных значений.
+
+    static constexpr uint64_t mask { capacity_value - 1 };
+
+public:
+    static constexpr std::size_t capacity { capacity_value };
+
+    ///
+    /// \brief Публикация нового значения (только для писателя).
+    ///
+    /// \param value Значение.
+    ///
+    void push(const value_type& value) noexcept
+    {
+        auto head = _head.load(std::memory_order_relaxed);
+        auto& cell = _slots[head & mask];
+        auto sequence = cell.sequence.load(std::memory_order_relaxed);
+        cell.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        cell.value = value;
+        cell.sequence.store(sequence + 2, std::memory_order_release);
+        _head.store(head + 1, std::memory_order_release);
+    }
+    ///
+    /// \brief Число опубликованных значений за все время.
+    ///
+    uint64_t head() const noexcept { return _head.load(std::memory_order_acquire); }
+    ///
+    /// \brief Чтение значения по абсолютному номеру.
+    ///
+    /// \param index Номер значения (меньше head()).
+    /// \param[out] value Значение.
+    /// \return \retval true значение прочитано \retval false значение уже перезаписано.
+    ///
+    bool read(uint64_t index, value_type& value) const noexcept
+    {
+        auto& cell = _slots[index & mask];
+        // ячейка хранит значение index, если в нее писали ровно (index / capacity + 1) раз
+        const auto expected = ((index / capacity_value) + 1) * 2;
+        for (;;) {
+            auto before = cell.sequence.load(std::memory_order_acquire);
+            if (before != expected) {
+                return false;
+            }
+            value = cell.value;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (cell.sequence.load(std::memory_order_relaxed) == before) {
+                return true;
+            }
+        }
+    }
+    ///
+    /// \brief Чтение последнего опубликованного значения.
+    ///
+    /// \param[out] value Значение.
+    /// \return \retval true значение прочитано \retval false буфер пуст.
+    ///
+    bool latest(value_type& value) const noexcept
+    {
+        for (;;) {
+            auto head = this->head();
+            if (!head) {
+                return false;
+            }
+            if (read(head - 1, value)) {
+                return true;
+            }
+        }
+    }
+};
+
+}
@@ -1,3 +1,10 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+
 #include "nebulaxi/resource_manager.hpp"
 
 #include "io/io.hxx"
@@ -14,13 +21,45 @@ struct resource_manager::private_data {
     logger::log_type log { logger::create_log("resource_manager") };
     const std::size_t max_mezzanine_index { 5 };
     std::size_t max_board_index { 64 };
-    board_list boards_list {};
+    std::size_t max_threads { std::max(1u, std::thread::hardware_concurrency()) };
+    board_registry_snapshot registry { std::make_shared<const board_registry>() };
+    std::mutex discovery {}; ///< Один поиск плат в каждый момент времени.
 };
 
 std::shared_ptr<resource_manager::private_data> resource_manager::d_ptr {
     std::make_shared<resource_manager::private_data>()
 };
 
+board_registry::board_registry(board_list boards)
+    : _boards { std::move(boards) }
+{
+    _by_serial.reserve(_boards.size());
+    _by_location.reserve(_boards.size());
+    for (std::size_t index {}; index < _boards.size(); ++index) {
+        auto& carrier = _boards[index].carrier;
+        // при совпадении ключей побеждает первая плата, как при линейном поиске
+        _by_serial.emplace(carrier->get_serial(), index);
+        _by_location.emplace(location_key(carrier->get_io()->get_location()), index);
+    }
+}
+
+uint64_t board_registry::location_key(const io_locaction& location) noexcept
+{
+    return (uint64_t(location.bus) << 32) | uint32_t(location.slot);
+}
+
+const board* board_registry::find_by_carrier_serial(const std::string& serial) const noexcept
+{
+    auto it = _by_serial.find(serial);
+    return it == _by_serial.end() ? nullptr : &_boards[it->second];
+}
+
+const board* board_registry::find_by_carrier_location(const io_locaction& location) const noexcept
+{
+    auto it = _by_location.find(location_key(location));
+    return it == _by_location.end() ? nullptr : &_boards[it->second];
+}
+
 void resource_manager::set_max_boards(std::size_t max_boards) noexcept
 {
     d_ptr->max_board_index = max_boards;
@@ -31,6 +70,16 @@ std::size_t resource_manager::get_max_boards() noexcept
     return d_ptr->max_board_index;
 }
 
+void resource_manager::set_max_threads(std::size_t max_threads) noexcept
+{
+    d_ptr->max_threads = std::max<std::size_t>(1, max_threads);
+}
+
+std::size_t resource_manager::get_max_threads() noexcept
+{
+    return d_ptr->max_threads;
+}
+
 board_info_list resource_manager::get_boards_info()
 {
     board_info_list info_list {};
@@ -55,71 +104,148 @@ board_info_list resource_manager::get_boards_info()
     return info_list;
 }
 
+namespace {
+
+constexpr io_type io_type_array[] { io_type::pcie, io_type::usb, io_type::zynq };
+
+struct board_probe {
+    board result {};
+    bool found {};
+    std::exception_ptr error {};
+};
+
+board create_board(io_type io_type, std::size_t carrier_index, std::size_t max_mezzanine_index)
+{
+    board board {};
+    board.carrier = carrier_creator::create(io_type, carrier_index);
+    for (std::size_t mezzanine_index {}; mezzanine_index < max_mezzanine_index; ++mezzanine_index)
+        try {
+            auto mezzanine = mezzanine_creator::create(board.carrier, mezzanine_index);
+            board.mezzanines_list.push_back(std::move(mezzanine));
+        } catch (const mezzanine_error& e) {
+            // TODO: добавить в лог
+            break;
+        }
+    return board;
+}
+
+}
+
 void resource_manager::find_boards()
+{
+    std::lock_guard lock { d_ptr->discovery };
+    discover();
+}
+
+void resource_manager::discover()
 {
     d_ptr->log = logger::get_log(d_ptr->log->name());
-    if (!d_ptr->boards_list.empty()) {
-        d_ptr->boards_list.clear();
-    }
-    const io_type io_type_array[] { io_type::pcie, io_type::usb, io_type::zynq };
-    for (auto io_type : io_type_array) {
-        for (std::size_t carrier_index {}; carrier_index < d_ptr->max_board_index; ++carrier_index)
+    const auto max_boards = d_ptr->max_board_index;
+    const auto max_mezzanines = d_ptr->max_mezzanine_index;
+    // Число плат каждого типа определяется открытием io по возрастанию индекса до первого
+    // отсутствующего (как при последовательном поиске), затем носители создаются параллельно,
+    // так что за первым отсутствующим индексом носители не открываются.
+    std::vector<std::pair<io_type, std::size_t>> present {};
+    for (auto type : io_type_array) {
+        for (std::size_t index {}; index < max_boards; ++index)
             try {
-                board board {};
-                board.carrier = carrier_creator::create(io_type, carrier_index);
-                for (int mezzanine_index {}; mezzanine_index < d_ptr->max_mezzanine_index; ++mezzanine_index)
-                    try {
-                        auto mezzanine = mezzanine_creator::create(board.carrier, mezzanine_index);
-                        board.mezzanines_list.push_back(std::move(mezzanine));
-                    } catch (const mezzanine_error& e) {
-                        // TODO: добавить в лог
-                        break;
-                    }
-                d_ptr->log->info("Find board name: {}, serial: {}", board.carrier->get_name(), board.carrier->get_serial());
-                d_ptr->boards_list.push_back(std::move(board));
+                io_impl::create(type, index);
+                present.emplace_back(type, index);
             } catch (const io_error& e) {
                 // TODO: добавить в лог
                 break;
             }
     }
+    std::vector<board_probe> probes(present.size());
+    std::atomic<std::size_t> next_probe {};
+    auto worker = [&] {
+        for (auto probe_index = next_probe++; probe_index < probes.size(); probe_index = next_probe++) {
+            auto& probe = probes[probe_index];
+            try {
+                probe.result = create_board(present[probe_index].first, present[probe_index].second, max_mezzanines);
+                probe.found = true;
+            } catch (const io_error& e) {
+                // плата пропала после проверки io
+            } catch (...) {
+                probe.error = std::current_exception();
+            }
+        }
+    };
+    std::vector<std::thread> workers {};
+    auto threads_count = std::min(d_ptr->max_threads, probes.size());
+    try {
+        for (std::size_t thread_index { 1 }; thread_index < threads_count; ++thread_index) {
+            workers.emplace_back(worker);
+        }
+    } catch (...) {
+        next_probe = probes.size();
+        for (auto& thread : workers) {
+            thread.join();
+        }
+        throw;
+    }
+    worker();
+    for (auto& thread : workers) {
+        thread.join();
+    }
+    board_list boards_list {};
+    for (auto& probe : probes) {
+        if (probe.error) {
+            std::rethrow_exception(probe.error);
+        }
+        if (!probe.found) {
+            continue;
+        }
+        auto& board = probe.result;
+        d_ptr->log->info("Find board name: {}, serial: {}", board.carrier->get_name(), board.carrier->get_serial());
+        boards_list.push_back(std::move(board));
+    }
+    std::atomic_store(&d_ptr->registry, std::make_shared<const board_registry>(std::move(boards_list)));
 }
 
-board_list resource_manager::get_boards()
+board_registry_snapshot resource_manager::get_registry()
 {
-    if (d_ptr->boards_list.empty()) {
-        find_boards();
+    auto registry = std::atomic_load(&d_ptr->registry);
+    if (registry->empty()) {
+        // параллельные первые вызовы ждут один поиск, а не запускают свои
+        std::lock_guard lock { d_ptr->discovery };
+        registry = std::atomic_load(&d_ptr->registry);
+        if (registry->empty()) {
+            discover();
+            registry = std::atomic_load(&d_ptr->registry);
+        }
     }
-    return d_ptr->boards_list;
+    return registry;
+}
+
+board_list resource_manager::get_boards()
+{
+    return get_registry()->boards();
 }
 
 board resource_manager::find_by_carrier_serial(const std::string& serial)
 {
-    auto& boards_list = d_ptr->boards_list;
-    if (boards_list.empty()) {
+    auto registry = std::atomic_load(&d_ptr->registry);
+    if (registry->empty()) {
         throw resource_manager_error("empty board list");
     }
-    auto it = std::find_if(boards_list.cbegin(), boards_list.cend(),
-        [&serial](const board& board) { return board.carrier->get_serial() == serial; });
-    if (it == boards_list.cend()) {
+    auto board = registry->find_by_carrier_serial(serial);
+    if (!board) {
         throw resource_manager_error("carrier not found [serial: " + serial + "]");
     }
-    return *it;
+    return *board;
 }
 
 board resource_manager::find_by_carrier_location(const io_locaction& location)
 {
-    auto& boards_list = d_ptr->boards_list;
-    if (boards_list.empty()) {
+    auto registry = std::atomic_load(&d_ptr->registry);
+    if (registry->empty()) {
         throw resource_manager_error("empty board list");
     }
-    auto it = std::find_if(boards_list.cbegin(), boards_list.cend(),
-        [&location](const board& board) {
-            auto real_location = board.carrier->get_io()->get_location();
-            return (real_location.bus == location.bus && real_location.slot == location.slot) ? true : false;
-        });
-    if (it == boards_list.cend()) {
+    auto board = registry->find_by_carrier_location(location);
+    if (!board) {
         auto location_string = std::to_string(location.bus) + '.' + std::to_string(location.slot);
         throw resource_manager_error("carrier not found [bus.slot: " + location_string + "]");
     }
-    return *it;
+    return *board;
 }
@@ -0,0 +1,367 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "nebulaxi/carrier.hpp"
+#include "nebulaxi/stream_group.hpp"
+
+#include "subsystems/dma_engine.hxx"
+
+using namespace std::chrono_literals;
+
+using namespace insys::nebulaxi;
+
+stream_group_error::stream_group_error(const std::string& message)
+    : nebulaxi_error(message, "[stream_group_error]: ")
+{
+}
+
+namespace {
+
+///
+/// \brief Узел NUMA устройства PCIe по шине и слоту.
+/// \details Расположение платы не содержит домена и функции, поэтому полный адрес
+/// (домен:шина:слот.функция) ищется среди устройств в sysfs. Если шина и слот
+/// совпадают у устройств разных доменов, узел считается неизвестным.
+///
+int get_numa_node(const io_locaction& location) noexcept
+try {
+    int node { -1 };
+    std::string domain {};
+    std::error_code error {};
+    for (auto& device : std::filesystem::directory_iterator("/sys/bus/pci/devices", error)) {
+        unsigned device_domain {}, bus {}, slot {}, function {};
+        auto name = device.path().filename().string();
+        if (std::sscanf(name.c_str(), "%x:%x:%x.%x", &device_domain, &bus, &slot, &function) != 4
+            || bus != location.bus || slot != location.slot) {
+            continue;
+        }
+        auto current_domain = name.substr(0, name.find(':'));
+        if (!domain.empty() && domain != current_domain) {
+            return -1;
+        }
+        domain = current_domain;
+        std::ifstream file { device.path() / "numa_node" };
+        int current_node { -1 };
+        if (node < 0 && (file >> current_node)) {
+            node = current_node;
+        }
+    }
+    return node;
+} catch (...) {
+    return -1;
+}
+
+///
+/// \brief Привязка текущего потока к процессорам узла NUMA.
+///
+/// \return \retval true поток привязан \retval false узел неизвестен или привязка не удалась.
+///
+bool pin_to_numa_node(int node) noexcept
+try {
+    if (node < 0) {
+        return false;
+    }
+    std::ifstream file { "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist" };
+    std::string cpulist {};
+    if (!std::getline(file, cpulist)) {
+        return false;
+    }
+    // формат списка: 0-7,16-23
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    std::istringstream ranges { cpulist };
+    for (std::string range {}; std::getline(ranges, range, ',');) {
+        auto dash = range.find('-');
+        auto first = std::stoi(range.substr(0, dash));
+        auto last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (auto cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu) {
+            CPU_SET(cpu, &cpus);
+        }
+    }
+    return ::pthread_setaffinity_np(::pthread_self(), sizeof(cpus), &cpus) == 0;
+} catch (...) {
+    return false;
+}
+
+///
+/// \brief Источник потока для симулируемой платы: генератор программного движка DMA.
+///
+///
+class simulate_stream_source final : public stream_source_interface {
+    std::shared_ptr<dma_ring> _ring {};
+    dma_loopback_engine _engine;
+
+public:
+    explicit simulate_stream_source(const stream_group_config& config)
+        : _ring { std::make_shared<dma_ring>(config.buffer_size, config.depth) }
+        , _engine { _ring }
+    {
+    }
+    dma_ring& get_ring() final { return *_ring; }
+    void start() final { _engine.start(); }
+    void stop() noexcept final
+    {
+        _ring->stop();
+        _engine.stop();
+    }
+};
+
+///
+/// \brief Источник по умолчанию.
+/// \details Подсистема main_stream не предоставляет кольца буферов DMA, поэтому для аппаратных
+/// плат источник передается фабрикой при создании группы.
+///
+stream_source create_default_source(const board& board, const stream_group_config& config)
+{
+    if (board.carrier && board.carrier->get_io()->is_simulate()) {
+        return std::make_shared<simulate_stream_source>(config);
+    }
+    throw stream_group_error("no default C2H stream source for hardware board, pass a source factory");
+}
+
+}
+
+struct stream_group::private_data {
+    struct worker {
+        board source_board {};
+        io_locaction location {};
+        int numa_node { -1 };
+        stream_source source {};
+        std::thread thread {};
+        std::atomic<uint64_t> buffers {};
+        std::atomic<uint64_t> bytes {};
+        std::deque<std::pair<const dma_buffer*, bool>> outstanding {}; ///< Выданные буферы и признак возврата.
+    };
+    stream_group_config config {};
+    source_factory factory {};
+    std::vector<std::unique_ptr<worker>> workers {};
+
+    std::mutex control {}; ///< Сериализация start и stop.
+    std::atomic<bool> running {};
+    std::vector<std::promise<void>> ready {}; ///< Готовность рабочих потоков текущего запуска.
+
+    std::mutex mutex {};
+    std::chrono::steady_clock::time_point started {}; ///< Защищено mutex.
+    std::chrono::steady_clock::time_point stopped {}; ///< Защищено mutex.
+    std::condition_variable available {};
+    std::deque<stream_packet> packets {};
+    uint64_t generation {}; ///< Номер текущего запуска, защищено mutex.
+
+    void run(std::size_t index)
+    {
+        auto& current = *workers[index];
+        try {
+            if (config.pin_workers) {
+                pin_to_numa_node(current.numa_node);
+            }
+            if (!current.source) {
+                current.source = factory(current.source_board, config);
+                // первое касание страниц из привязанного потока размещает буферы на узле платы
+                auto& ring = current.source->get_ring();
+                for (std::size_t buffer = 0; buffer < ring.depth(); ++buffer) {
+                    std::memset(ring.buffer(buffer).data, 0, ring.buffer_size());
+                }
+            }
+            current.source->get_ring().reset();
+            current.source->start();
+            ready[index].set_value();
+        } catch (...) {
+            ready[index].set_exception(std::current_exception());
+            return;
+        }
+        auto& ring = current.source->get_ring();
+        while (running.load(std::memory_order_acquire)) {
+            auto buffer = ring.acquire_filled(10ms);
+            if (!buffer) {
+                continue;
+            }
+            current.buffers.fetch_add(1, std::memory_order_relaxed);
+            current.bytes.fetch_add(buffer->used, std::memory_order_relaxed);
+            {
+                std::lock_guard lock { mutex };
+                current.outstanding.emplace_back(buffer, false);
+                packets.push_back({ index, current.location, buffer, generation });
+            }
+            available.notify_one();
+        }
+        current.source->stop();
+    }
+    ///
+    /// \brief Остановка рабочих потоков, вызывается под control.
+    ///
+    void shutdown() noexcept
+    {
+        if (!running.exchange(false)) {
+            return;
+        }
+        available.notify_all();
+        for (auto& current : workers) {
+            if (current->thread.joinable()) {
+                current->thread.join();
+            }
+        }
+        std::lock_guard lock { mutex };
+        stopped = std::chrono::steady_clock::now();
+    }
+};
+
+stream_group::stream_group(const board_list& boards, const stream_group_config& config, source_factory factory)
+    : d_ptr { std::make_shared<private_data>() }
+{
+    if (boards.empty()) {
+        throw stream_group_error("empty board list");
+    }
+    d_ptr->config = config;
+    d_ptr->factory = factory ? std::move(factory) : create_default_source;
+    for (auto& board : boards) {
+        auto current = std::make_unique<private_data::worker>();
+        current->source_board = board;
+        if (board.carrier) {
+            current->location = board.carrier->get_io()->get_location();
+            current->numa_node = get_numa_node(current->location);
+        }
+        d_ptr->workers.push_back(std::move(current));
+    }
+}
+
+stream_group::~stream_group() noexcept
+{
+    stop();
+}
+
+void stream_group::start()
+{
+    std::lock_guard control { d_ptr->control };
+    if (d_ptr->running.exchange(true)) {
+        return;
+    }
+    {
+        // буферы предыдущего запуска у потребителя становятся недействительными, см. release
+        std::lock_guard lock { d_ptr->mutex };
+        ++d_ptr->generation;
+        d_ptr->packets.clear();
+        for (auto& current : d_ptr->workers) {
+            current->outstanding.clear();
+            current->buffers = 0;
+            current->bytes = 0;
+        }
+    }
+    d_ptr->ready = std::vector<std::promise<void>>(d_ptr->workers.size());
+    std::vector<std::future<void>> ready {};
+    for (auto& promise : d_ptr->ready) {
+        ready.push_back(promise.get_future());
+    }
+    try {
+        for (std::size_t index = 0; index < d_ptr->workers.size(); ++index) {
+            d_ptr->workers[index]->thread = std::thread([data = d_ptr, index] { data->run(index); });
+        }
+    } catch (...) {
+        // запущенные потоки завершаются по сбросу running
+        d_ptr->shutdown();
+        throw;
+    }
+    std::exception_ptr error {};
+    for (auto& future : ready) {
+        try {
+            future.get();
+        } catch (...) {
+            error = error ? error : std::current_exception();
+        }
+    }
+    {
+        std::lock_guard lock { d_ptr->mutex };
+        d_ptr->started = std::chrono::steady_clock::now();
+    }
+    if (error) {
+        d_ptr->shutdown();
+        std::rethrow_exception(error);
+    }
+}
+
+void stream_group::stop() noexcept
+{
+    std::lock_guard control { d_ptr->control };
+    d_ptr->shutdown();
+}
+
+bool stream_group::is_running() const noexcept
+{
+    return d_ptr->running.load(std::memory_order_acquire);
+}
+
+std::size_t stream_group::size() const noexcept
+{
+    return d_ptr->workers.size();
+}
+
+bool stream_group::acquire(stream_packet& packet, std::chrono::microseconds timeout)
+{
+    std::unique_lock lock { d_ptr->mutex };
+    if (!d_ptr->available.wait_for(lock, timeout, [this] { return !d_ptr->packets.empty() || !is_running(); })
+        || d_ptr->packets.empty()) {
+        return false;
+    }
+    packet = d_ptr->packets.front();
+    d_ptr->packets.pop_front();
+    return true;
+}
+
+void stream_group::release(const stream_packet& packet)
+{
+    if (packet.board_index >= d_ptr->workers.size()) {
+        throw stream_group_error("invalid packet");
+    }
+    auto& current = *d_ptr->workers[packet.board_index];
+    std::lock_guard lock { d_ptr->mutex };
+    if (packet.generation != d_ptr->generation) {
+        return;
+    }
+    auto it = std::find_if(current.outstanding.begin(), current.outstanding.end(),
+        [&packet](auto& entry) { return entry.first == packet.buffer && !entry.second; });
+    if (it == current.outstanding.end()) {
+        throw stream_group_error("packet was not acquired");
+    }
+    it->second = true;
+    // кольцо принимает буферы в порядке выдачи
+    auto& ring = current.source->get_ring();
+    while (!current.outstanding.empty() && current.outstanding.front().second) {
+        ring.release(const_cast<dma_buffer*>(current.outstanding.front().first));
+        current.outstanding.pop_front();
+    }
+}
+
+stream_group_stats stream_group::get_stats() const
+{
+    stream_group_stats stats {};
+    {
+        std::lock_guard lock { d_ptr->mutex };
+        auto end = is_running() ? std::chrono::steady_clock::now() : d_ptr->stopped;
+        stats.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - d_ptr->started);
+    }
+    auto seconds = std::chrono::duration<double>(stats.elapsed).count();
+    for (auto& current : d_ptr->workers) {
+        stream_board_stats board_stats {};
+        board_stats.location = current->location;
+        board_stats.numa_node = current->numa_node;
+        board_stats.buffers = current->buffers.load(std::memory_order_relaxed);
+        board_stats.bytes = current->bytes.load(std::memory_order_relaxed);
+        board_stats.bandwidth = seconds > 0 ? board_stats.bytes / seconds : 0.;
+        stats.bytes += board_stats.bytes;
+        stats.boards.push_back(board_stats);
+    }
+    stats.bandwidth = seconds > 0 ? stats.bytes / seconds : 0.;
+    return stats;
+}
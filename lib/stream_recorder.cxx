@@ -0,0 +1,401 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "nebulaxi/stream_recorder.hpp"
+
+using namespace std::chrono_literals;
+
+using namespace insys::nebulaxi;
+
+stream_recorder_error::stream_recorder_error(const std::string& message)
+    : nebulaxi_error(message, "[stream_recorder_error]: ")
+{
+}
+
+namespace {
+
+constexpr std::size_t block_size { 4096 }; ///< Выравнивание смещений и размеров для O_DIRECT.
+
+std::size_t align_up(std::size_t value) noexcept
+{
+    return (value + block_size - 1) / block_size * block_size;
+}
+
+///
+/// \brief Выровненный по блоку промежуточный буфер потока записи.
+///
+///
+class aligned_buffer final {
+    std::byte* _data {};
+    std::size_t _size {};
+
+public:
+    aligned_buffer() = default;
+    aligned_buffer(const aligned_buffer&) = delete;
+    aligned_buffer& operator=(const aligned_buffer&) = delete;
+    ~aligned_buffer() noexcept { release(); }
+    std::byte* reserve(std::size_t size)
+    {
+        if (size > _size) {
+            release();
+            _data = static_cast<std::byte*>(::operator new(size, std::align_val_t(block_size)));
+            _size = size;
+        }
+        return _data;
+    }
+    void release() noexcept
+    {
+        if (_data) {
+            ::operator delete(_data, std::align_val_t(block_size));
+        }
+        _data = nullptr;
+        _size = 0;
+    }
+};
+
+void write_all(int fd, const std::byte* data, std::size_t size, uint64_t offset)
+{
+    while (size) {
+        auto written = ::pwrite(fd, data, size, off_t(offset));
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw stream_recorder_error(std::string("write failed: ") + std::strerror(errno));
+        }
+        data += written;
+        size -= std::size_t(written);
+        offset += uint64_t(written);
+    }
+}
+
+}
+
+struct stream_recorder::private_data {
+    struct segment {
+        int fd { -1 };
+        uint64_t used {}; ///< Занятый размер (с выравниванием).
+    };
+    struct job {
+        const std::byte* data {};
+        int fd { -1 };
+        bool direct_io {};
+        stream_index_entry entry {};
+        std::function<void()> on_written {};
+    };
+    stream_recorder_config config {};
+    bool direct_io {};
+
+    std::mutex mutex {};
+    std::condition_variable not_full {};
+    std::condition_variable not_empty {};
+    std::condition_variable idle {};
+    std::deque<job> queue {};
+    std::size_t in_flight {}; ///< Поставленные, но еще не записанные буферы.
+    bool closing {};
+    bool closed {};
+    std::vector<segment> segments {};
+    uint64_t sequence {};
+    std::exception_ptr error {};
+    std::vector<std::thread> writers {};
+    std::mutex close_mutex {}; ///< Один close() в каждый момент времени.
+
+    std::mutex index_mutex {};
+    std::ofstream index {}; ///< Защищено index_mutex.
+    uint64_t index_next {}; ///< Следующий номер буфера для индекса, защищено index_mutex.
+    std::map<uint64_t, std::optional<stream_index_entry>> index_pending {}; ///< Завершенные не по порядку, защищено index_mutex.
+
+    std::atomic<uint64_t> buffers {};
+    std::atomic<uint64_t> bytes {};
+    std::atomic<uint64_t> backpressure_waits {};
+    std::chrono::steady_clock::time_point first_submit {};
+    std::chrono::steady_clock::time_point last_written {};
+
+    ///
+    /// \brief Открытие следующего сегмента (под блокировкой).
+    ///
+    void open_segment()
+    {
+        auto path = config.directory / (config.prefix + "_" + std::to_string(segments.size()) + ".dat");
+        auto flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+        int fd = direct_io ? ::open(path.c_str(), flags | O_DIRECT, 0644) : -1;
+        if (fd < 0 && direct_io) {
+            // файловая система не поддерживает O_DIRECT (например, tmpfs)
+            direct_io = false;
+        }
+        if (fd < 0) {
+            fd = ::open(path.c_str(), flags, 0644);
+        }
+        if (fd < 0) {
+            throw stream_recorder_error("can't open " + path.string() + ": " + std::strerror(errno));
+        }
+        // ошибка предварительного выделения не критична, файл будет расти по мере записи
+        ::posix_fallocate(fd, 0, off_t(config.segment_size));
+        segments.push_back({ fd, 0 });
+    }
+    void set_error(std::exception_ptr current) noexcept
+    {
+        std::lock_guard error_lock { mutex };
+        error = error ? error : current;
+    }
+    void write_job(const job& current, aligned_buffer& bounce)
+    {
+        auto size = std::size_t(current.entry.size);
+        if (!current.direct_io) {
+            write_all(current.fd, current.data, size, current.entry.offset);
+            return;
+        }
+        auto aligned = reinterpret_cast<std::uintptr_t>(current.data) % block_size == 0;
+        auto head = aligned ? size / block_size * block_size : 0;
+        if (head) {
+            write_all(current.fd, current.data, head, current.entry.offset);
+        }
+        if (head < size) {
+            // остаток дополняется нулями до границы блока
+            auto tail = align_up(size - head);
+            auto data = bounce.reserve(tail);
+            std::memcpy(data, current.data + head, size - head);
+            std::memset(data + (size - head), 0, tail - (size - head));
+            write_all(current.fd, data, tail, current.entry.offset + head);
+        }
+    }
+    ///
+    /// \brief Добавление записи в индекс в порядке номеров буферов.
+    /// \details Потоки записи завершают буферы в произвольном порядке, поэтому записи, пришедшие
+    /// раньше предыдущих номеров, откладываются. Буфер, запись которого не удалась, в индекс не
+    /// попадает, но освобождает очередь для следующих.
+    ///
+    /// \param sequence Номер буфера.
+    /// \param entry Запись индекса, пусто - буфер не записан.
+    ///
+    void index_complete(uint64_t sequence, const std::optional<stream_index_entry>& entry)
+    {
+        std::lock_guard index_lock { index_mutex };
+        index_pending.emplace(sequence, entry);
+        for (auto it = index_pending.begin(); it != index_pending.end() && it->first == index_next;
+             it = index_pending.erase(it), ++index_next) {
+            if (it->second) {
+                index.write(reinterpret_cast<const char*>(&*it->second), sizeof(stream_index_entry));
+            }
+        }
+        if (!index) {
+            throw stream_recorder_error("index write failed");
+        }
+    }
+    void run()
+    {
+        aligned_buffer bounce {};
+        std::unique_lock lock { mutex };
+        for (;;) {
+            not_empty.wait(lock, [this] { return closing || !queue.empty(); });
+            if (queue.empty()) {
+                return;
+            }
+            auto current = std::move(queue.front());
+            queue.pop_front();
+            lock.unlock();
+            not_full.notify_one();
+            auto written = false;
+            try {
+                write_job(current, bounce);
+                written = true;
+                buffers.fetch_add(1, std::memory_order_relaxed);
+                bytes.fetch_add(current.entry.size, std::memory_order_relaxed);
+            } catch (...) {
+                set_error(std::current_exception());
+            }
+            try {
+                index_complete(current.entry.sequence, written ? std::optional { current.entry } : std::nullopt);
+            } catch (...) {
+                set_error(std::current_exception());
+            }
+            try {
+                if (current.on_written) {
+                    current.on_written();
+                }
+            } catch (...) {
+            }
+            lock.lock();
+            last_written = std::chrono::steady_clock::now();
+            if (!--in_flight) {
+                idle.notify_all();
+            }
+        }
+    }
+};
+
+stream_recorder::stream_recorder(const stream_recorder_config& config)
+    : d_ptr { std::make_shared<private_data>() }
+{
+    if (!config.writers || !config.queue_depth || config.segment_size < block_size) {
+        throw stream_recorder_error("invalid recorder configuration");
+    }
+    d_ptr->config = config;
+    d_ptr->config.segment_size = config.segment_size / block_size * block_size;
+    d_ptr->direct_io = config.direct_io;
+    std::filesystem::create_directories(config.directory);
+    auto index_path = config.directory / (config.prefix + ".index");
+    d_ptr->index.open(index_path, std::ios::binary | std::ios::trunc);
+    if (!d_ptr->index) {
+        throw stream_recorder_error("can't open " + index_path.string());
+    }
+    try {
+        for (std::size_t writer = 0; writer < config.writers; ++writer) {
+            d_ptr->writers.emplace_back([data = d_ptr] { data->run(); });
+        }
+    } catch (...) {
+        close();
+        throw;
+    }
+}
+
+stream_recorder::~stream_recorder() noexcept
+{
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+void stream_recorder::submit(const dma_buffer& buffer, uint32_t source, std::function<void()> on_written)
+{
+    if (align_up(buffer.used) > d_ptr->config.segment_size) {
+        throw stream_recorder_error("buffer is larger than a segment");
+    }
+    std::unique_lock lock { d_ptr->mutex };
+    if (d_ptr->queue.size() >= d_ptr->config.queue_depth && !d_ptr->closing && !d_ptr->error) {
+        d_ptr->backpressure_waits.fetch_add(1, std::memory_order_relaxed);
+        d_ptr->not_full.wait(lock, [this] {
+            return d_ptr->closing || d_ptr->error || d_ptr->queue.size() < d_ptr->config.queue_depth;
+        });
+    }
+    // close() мог начаться во время ожидания: после выхода писателей задание не было бы записано
+    if (d_ptr->closing) {
+        throw stream_recorder_error("recorder is closed");
+    }
+    if (d_ptr->error) {
+        std::rethrow_exception(d_ptr->error);
+    }
+    auto padded = align_up(buffer.used);
+    if (d_ptr->segments.empty() || d_ptr->segments.back().used + padded > d_ptr->config.segment_size) {
+        d_ptr->open_segment();
+    }
+    auto& current_segment = d_ptr->segments.back();
+    private_data::job current {};
+    current.data = buffer.data;
+    current.fd = current_segment.fd;
+    current.direct_io = d_ptr->direct_io;
+    current.entry.sequence = d_ptr->sequence++;
+    current.entry.timestamp = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch())
+                                           .count());
+    current.entry.source = source;
+    current.entry.segment = uint32_t(d_ptr->segments.size() - 1);
+    current.entry.offset = current_segment.used;
+    current.entry.size = buffer.used;
+    current.on_written = std::move(on_written);
+    current_segment.used += padded;
+    if (!current.entry.sequence) {
+        d_ptr->first_submit = std::chrono::steady_clock::now();
+    }
+    ++d_ptr->in_flight;
+    d_ptr->queue.push_back(std::move(current));
+    lock.unlock();
+    d_ptr->not_empty.notify_one();
+}
+
+std::size_t stream_recorder::record(stream_group& group, std::chrono::milliseconds duration)
+{
+    std::size_t count {};
+    auto deadline = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < deadline) {
+        stream_packet packet {};
+        if (!group.acquire(packet, 10ms)) {
+            continue;
+        }
+        try {
+            submit(*packet.buffer, uint32_t(packet.board_index), [&group, packet] { group.release(packet); });
+        } catch (...) {
+            group.release(packet);
+            throw;
+        }
+        ++count;
+    }
+    flush();
+    return count;
+}
+
+void stream_recorder::flush()
+{
+    std::unique_lock lock { d_ptr->mutex };
+    d_ptr->idle.wait(lock, [this] { return !d_ptr->in_flight; });
+    if (d_ptr->error) {
+        std::rethrow_exception(d_ptr->error);
+    }
+}
+
+void stream_recorder::close()
+{
+    std::lock_guard close_lock { d_ptr->close_mutex };
+    {
+        std::lock_guard lock { d_ptr->mutex };
+        if (d_ptr->closed) {
+            return;
+        }
+        d_ptr->closing = true;
+    }
+    d_ptr->not_empty.notify_all();
+    d_ptr->not_full.notify_all();
+    for (auto& writer : d_ptr->writers) {
+        writer.join();
+    }
+    d_ptr->writers.clear();
+    std::lock_guard lock { d_ptr->mutex };
+    d_ptr->closed = true;
+    // предварительно выделенное место за последним буфером освобождается
+    for (auto& current : d_ptr->segments) {
+        [[maybe_unused]] auto result = ::ftruncate(current.fd, off_t(current.used));
+        ::close(current.fd);
+    }
+    {
+        std::lock_guard index_lock { d_ptr->index_mutex };
+        d_ptr->index.close();
+        if (!d_ptr->index && !d_ptr->error) {
+            d_ptr->error = std::make_exception_ptr(stream_recorder_error("index write failed"));
+        }
+    }
+    if (d_ptr->error) {
+        std::rethrow_exception(d_ptr->error);
+    }
+}
+
+stream_recorder_stats stream_recorder::get_stats() const
+{
+    std::lock_guard lock { d_ptr->mutex };
+    stream_recorder_stats stats {};
+    stats.buffers = d_ptr->buffers.load(std::memory_order_relaxed);
+    stats.bytes = d_ptr->bytes.load(std::memory_order_relaxed);
+    stats.segments = d_ptr->segments.size();
+    stats.backpressure_waits = d_ptr->backpressure_waits.load(std::memory_order_relaxed);
+    stats.direct_io = d_ptr->direct_io;
+    if (stats.buffers) {
+        stats.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(d_ptr->last_written - d_ptr->first_submit);
+        auto seconds = std::chrono::duration<double>(stats.elapsed).count();
+        stats.bandwidth = seconds > 0 ? stats.bytes / seconds : 0.;
+    }
+    return stats;
+}
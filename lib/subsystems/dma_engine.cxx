@@ -0,0 +1,117 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#include "subsystems/dma_engine.hxx"
+
+using namespace std::chrono_literals;
+
+using namespace insys::nebulaxi;
+
+struct dma_loopback_engine::private_data {
+    std::shared_ptr<dma_ring> c2h {};
+    std::shared_ptr<dma_ring> h2c {};
+    std::atomic<bool> running {};
+    std::thread thread {};
+    uint64_t counter {}; ///< Следующее слово генератора.
+    std::mutex error_mutex {};
+    std::exception_ptr error {}; ///< Исключение потока движка.
+
+    void transfer(dma_buffer*& output)
+    {
+        while (running.load(std::memory_order_acquire)) {
+            if (!output && !(output = c2h->acquire_free(10ms))) {
+                continue;
+            }
+            if (h2c) {
+                auto input = h2c->acquire_filled(10ms);
+                if (!input) {
+                    continue;
+                }
+                auto size = std::min(input->used, output->size);
+                std::memcpy(output->data, input->data, size);
+                h2c->release(input);
+                c2h->commit(output, size);
+            } else {
+                auto words = output->size / sizeof(uint64_t);
+                auto data = reinterpret_cast<uint64_t*>(output->data);
+                for (std::size_t word = 0; word < words; ++word) {
+                    data[word] = counter++;
+                }
+                c2h->commit(output, words * sizeof(uint64_t));
+            }
+            output = nullptr;
+        }
+    }
+    void run() noexcept
+    {
+        dma_buffer* output {};
+        try {
+            transfer(output);
+            // буфер, полученный до остановки, возвращается, иначе следующий запуск нарушит порядок передачи
+            if (output) {
+                c2h->abandon(output);
+            }
+        } catch (...) {
+            {
+                std::lock_guard lock { error_mutex };
+                error = std::current_exception();
+            }
+            running.store(false, std::memory_order_release);
+            c2h->stop();
+        }
+    }
+};
+
+dma_loopback_engine::dma_loopback_engine(std::shared_ptr<dma_ring> c2h, std::shared_ptr<dma_ring> h2c)
+    : d_ptr { std::make_shared<private_data>() }
+{
+    if (!c2h) {
+        throw dma_ring_error("loopback engine requires a receive ring");
+    }
+    d_ptr->c2h = std::move(c2h);
+    d_ptr->h2c = std::move(h2c);
+}
+
+dma_loopback_engine::~dma_loopback_engine() noexcept
+{
+    stop();
+}
+
+void dma_loopback_engine::start()
+{
+    if (d_ptr->running.exchange(true)) {
+        return;
+    }
+    if (d_ptr->thread.joinable()) {
+        // поток, остановленный ошибкой
+        d_ptr->thread.join();
+    }
+    {
+        std::lock_guard lock { d_ptr->error_mutex };
+        d_ptr->error = nullptr;
+    }
+    d_ptr->thread = std::thread([data = d_ptr] { data->run(); });
+}
+
+void dma_loopback_engine::stop() noexcept
+{
+    // поток, остановленный ошибкой, тоже требует join
+    d_ptr->running.store(false, std::memory_order_release);
+    if (d_ptr->thread.joinable()) {
+        d_ptr->thread.join();
+    }
+}
+
+bool dma_loopback_engine::is_running() const noexcept
+{
+    return d_ptr->running.load(std::memory_order_acquire);
+}
+
+std::exception_ptr dma_loopback_engine::get_error() const noexcept
+{
+    std::lock_guard lock { d_ptr->error_mutex };
+    return d_ptr->error;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <exception>
+#include <memory>
+
+#include "nebulaxi/subsystems/dma_ring.hpp"
+
+namespace insys::nebulaxi {
+
+///
+/// \brief Движок DMA, обслуживающий кольца буферов.
+///
+///
+struct dma_engine_interface {
+    virtual void start() = 0;
+    virtual void stop() noexcept = 0;
+    virtual bool is_running() const noexcept = 0;
+    ///
+    /// \brief Ошибка, остановившая движок, или пустой указатель.
+    ///
+    virtual std::exception_ptr get_error() const noexcept = 0;
+    virtual ~dma_engine_interface() noexcept = default;
+};
+
+using dma_engine = std::shared_ptr<dma_engine_interface>;
+
+///
+/// \brief Программный движок DMA для режима симуляции.
+/// \details Если задано кольцо передачи (h2c), данные из него переносятся в кольцо приема (c2h),
+/// иначе буферы приема заполняются возрастающими 64-битными словами, которые потребитель может проверить.
+/// Исключение в потоке движка сохраняется (get_error) и останавливает кольцо приема,
+/// чтобы потребитель не ждал данных, которых не будет.
+///
+class dma_loopback_engine final : public dma_engine_interface {
+    struct private_data;
+    std::shared_ptr<private_data> d_ptr {};
+
+public:
+    ///
+    /// \brief Конструктор движка.
+    ///
+    /// \param c2h Кольцо приема.
+    /// \param h2c Кольцо передачи, nullptr - режим генератора.
+    ///
+    dma_loopback_engine(std::shared_ptr<dma_ring> c2h, std::shared_ptr<dma_ring> h2c = {});
+    ~dma_loopback_engine() noexcept;
+
+    void start() final;
+    void stop() noexcept final;
+    bool is_running() const noexcept final;
+    std::exception_ptr get_error() const noexcept final;
+};
+
+}
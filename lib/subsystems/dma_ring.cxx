@@ -0,0 +1,205 @@
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#include <unistd.h>
+
+#include "nebulaxi/subsystems/dma_ring.hpp"
+
+using namespace insys::nebulaxi;
+
+dma_ring_error::dma_ring_error(const std::string& message)
+    : subsystem_error(message, "[dma_ring_error]: ")
+{
+}
+
+namespace {
+
+///
+/// \brief Освобождение памяти, выделенной с выравниванием по странице.
+///
+struct aligned_delete {
+    std::size_t alignment {};
+    void operator()(std::byte* memory) const noexcept
+    {
+        ::operator delete(memory, std::align_val_t(alignment));
+    }
+};
+
+}
+
+struct dma_ring::private_data {
+    std::size_t buffer_size {};
+    std::unique_ptr<std::byte, aligned_delete> memory {}; ///< Память всех буферов, выровнена по странице.
+    std::vector<dma_buffer> buffers {};
+
+    // счетчики растут монотонно, позиция в кольце - остаток от деления на глубину
+    std::atomic<uint64_t> produced {}; ///< Заполнено производителем.
+    std::atomic<uint64_t> consumed {}; ///< Возвращено потребителем.
+    // получение и возврат буфера одной стороной могут выполняться в разных потоках, но не одновременно
+    std::atomic<uint64_t> reserved {}; ///< Выдано производителю.
+    std::atomic<uint64_t> taken {}; ///< Выдано потребителю.
+    std::atomic<bool> stopped {};
+
+    std::mutex mutex {};
+    std::condition_variable changed {};
+
+    std::atomic<uint64_t> bytes {};
+    std::atomic<uint64_t> producer_stalls {};
+    std::atomic<uint64_t> consumer_stalls {};
+
+    void notify()
+    {
+        {
+            std::lock_guard lock { mutex };
+        }
+        changed.notify_all();
+    }
+    template <typename predicate_type>
+    bool wait(std::chrono::microseconds timeout, std::atomic<uint64_t>& stalls, predicate_type&& ready)
+    {
+        if (ready())
+            return true;
+        stalls.fetch_add(1, std::memory_order_relaxed);
+        std::unique_lock lock { mutex };
+        changed.wait_for(lock, timeout, [&] { return ready() || stopped.load(std::memory_order_acquire); });
+        return ready();
+    }
+};
+
+dma_ring::dma_ring(std::size_t buffer_size, std::size_t depth)
+    : d_ptr { std::make_shared<private_data>() }
+{
+    if (!buffer_size || !depth) {
+        throw dma_ring_error("invalid ring geometry");
+    }
+    auto page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    if (buffer_size > SIZE_MAX - page_size + 1) {
+        throw dma_ring_error("ring buffer size overflow");
+    }
+    d_ptr->buffer_size = (buffer_size + page_size - 1) / page_size * page_size;
+    if (d_ptr->buffer_size > SIZE_MAX / depth) {
+        throw dma_ring_error("ring size overflow");
+    }
+    d_ptr->memory = { static_cast<std::byte*>(::operator new(d_ptr->buffer_size * depth, std::align_val_t(page_size))),
+        aligned_delete { page_size } };
+    d_ptr->buffers.resize(depth);
+    for (std::size_t index = 0; index < depth; ++index) {
+        auto& buffer = d_ptr->buffers[index];
+        buffer.data = d_ptr->memory.get() + index * d_ptr->buffer_size;
+        buffer.size = d_ptr->buffer_size;
+        buffer.index = index;
+    }
+}
+
+dma_ring::~dma_ring() noexcept
+{
+    stop();
+}
+
+std::size_t dma_ring::buffer_size() const noexcept { return d_ptr->buffer_size; }
+std::size_t dma_ring::depth() const noexcept { return d_ptr->buffers.size(); }
+
+dma_buffer& dma_ring::buffer(std::size_t index) const
+{
+    if (index >= d_ptr->buffers.size()) {
+        throw dma_ring_error("buffer index out of range");
+    }
+    return d_ptr->buffers[index];
+}
+
+dma_buffer* dma_ring::acquire_free(std::chrono::microseconds timeout)
+{
+    auto depth = d_ptr->buffers.size();
+    auto ready = [this, depth] {
+        return d_ptr->reserved.load(std::memory_order_relaxed) - d_ptr->consumed.load(std::memory_order_acquire) < depth;
+    };
+    if (d_ptr->stopped.load(std::memory_order_acquire) || !d_ptr->wait(timeout, d_ptr->producer_stalls, ready)) {
+        return nullptr;
+    }
+    return &d_ptr->buffers[d_ptr->reserved.fetch_add(1, std::memory_order_relaxed) % depth];
+}
+
+void dma_ring::commit(dma_buffer* buffer, std::size_t used)
+{
+    auto produced = d_ptr->produced.load(std::memory_order_relaxed);
+    if (!buffer || buffer->index != produced % d_ptr->buffers.size() || produced == d_ptr->reserved.load(std::memory_order_relaxed)) {
+        throw dma_ring_error("buffers must be committed in acquisition order");
+    }
+    buffer->used = std::min(used, buffer->size);
+    buffer->sequence = produced;
+    d_ptr->bytes.fetch_add(buffer->used, std::memory_order_relaxed);
+    d_ptr->produced.store(produced + 1, std::memory_order_release);
+    d_ptr->notify();
+}
+
+void dma_ring::abandon(dma_buffer* buffer)
+{
+    auto reserved = d_ptr->reserved.load(std::memory_order_relaxed);
+    if (!buffer || reserved == d_ptr->produced.load(std::memory_order_relaxed)
+        || buffer->index != (reserved - 1) % d_ptr->buffers.size()) {
+        throw dma_ring_error("only the last acquired buffer can be abandoned");
+    }
+    d_ptr->reserved.store(reserved - 1, std::memory_order_relaxed);
+}
+
+dma_buffer* dma_ring::acquire_filled(std::chrono::microseconds timeout)
+{
+    auto ready = [this] { return d_ptr->taken.load(std::memory_order_relaxed) < d_ptr->produced.load(std::memory_order_acquire); };
+    if (!d_ptr->wait(timeout, d_ptr->consumer_stalls, ready)) {
+        return nullptr;
+    }
+    return &d_ptr->buffers[d_ptr->taken.fetch_add(1, std::memory_order_relaxed) % d_ptr->buffers.size()];
+}
+
+void dma_ring::release(dma_buffer* buffer)
+{
+    auto consumed = d_ptr->consumed.load(std::memory_order_relaxed);
+    if (!buffer || buffer->index != consumed % d_ptr->buffers.size() || consumed == d_ptr->taken.load(std::memory_order_relaxed)) {
+        throw dma_ring_error("buffers must be released in acquisition order");
+    }
+    buffer->used = 0;
+    d_ptr->consumed.store(consumed + 1, std::memory_order_release);
+    d_ptr->notify();
+}
+
+void dma_ring::stop() noexcept
+{
+    d_ptr->stopped.store(true, std::memory_order_release);
+    d_ptr->notify();
+}
+
+bool dma_ring::is_stopped() const noexcept
+{
+    return d_ptr->stopped.load(std::memory_order_acquire);
+}
+
+void dma_ring::reset() noexcept
+{
+    d_ptr->produced.store(0, std::memory_order_relaxed);
+    d_ptr->consumed.store(0, std::memory_order_relaxed);
+    d_ptr->reserved.store(0, std::memory_order_relaxed);
+    d_ptr->taken.store(0, std::memory_order_relaxed);
+    d_ptr->bytes.store(0, std::memory_order_relaxed);
+    d_ptr->producer_stalls.store(0, std::memory_order_relaxed);
+    d_ptr->consumer_stalls.store(0, std::memory_order_relaxed);
+    for (auto& buffer : d_ptr->buffers) {
+        buffer.used = 0;
+        buffer.sequence = 0;
+    }
+    d_ptr->stopped.store(false, std::memory_order_release);
+}
+
+dma_ring_stats dma_ring::get_stats() const noexcept
+{
+    dma_ring_stats stats {};
+    stats.buffers = d_ptr->produced.load(std::memory_order_relaxed);
+    stats.bytes = d_ptr->bytes.load(std::memory_order_relaxed);
+    stats.producer_stalls = d_ptr->producer_stalls.load(std::memory_order_relaxed);
+    stats.consumer_stalls = d_ptr->consumer_stalls.load(std::memory_order_relaxed);
+    return stats;
+}
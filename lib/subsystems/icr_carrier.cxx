@@ -1,8 +1,16 @@
+#include <algorithm>
 #include <array>
+#include <cctype>
+#include <fstream>
+#include <map>
+#include <mutex>
 #include <sstream>
+#include <string_view>
 
 #include <boost/property_tree/json_parser.hpp>
 
+#include "nebulaxi/io/io.hpp"
+
 #include "chips/_93aa66.hxx"
 #include "subsystems/icr_carrier.hxx"
 #include "subsystems/subsystem_base.hxx"
@@ -25,12 +33,269 @@ struct icr_carrier_memory_not_found : icr_carrier_error {
     }
 };
 
+namespace {
+
+///
+/// \brief Поля идентификации носителя в ICR.
+///
+///
+struct icr_identity {
+    std::string name { "undefined" };
+    std::string version { "undefined" };
+    std::string type { "undefined" };
+    std::string serial { "undefined" };
+
+    std::string* field(std::string_view key) noexcept
+    {
+        if (key == "name")
+            return &name;
+        if (key == "version")
+            return &version;
+        if (key == "type")
+            return &type;
+        if (key == "sn")
+            return &serial;
+        return nullptr;
+    }
+};
+
+///
+/// \brief Разбор идентификации ICR без построения дерева JSON.
+/// \details Разбирается объект верхнего уровня прямо в буфере прочитанных данных,
+/// копируются только значения нужных полей, вложенные значения пропускаются.
+///
+class icr_identity_parser final {
+    std::string_view _text {};
+    std::size_t _pos {};
+
+    void skip_spaces() noexcept
+    {
+        while (_pos < _text.size() && std::isspace(static_cast<unsigned char>(_text[_pos])))
+            ++_pos;
+    }
+    bool consume(char ch) noexcept
+    {
+        skip_spaces();
+        if (_pos < _text.size() && _text[_pos] == ch) {
+            ++_pos;
+            return true;
+        }
+        return false;
+    }
+    bool parse_string(std::string_view& raw) noexcept
+    {
+        if (!consume('"'))
+            return false;
+        auto begin = _pos;
+        while (_pos < _text.size()) {
+            auto ch = _text[_pos++];
+            if (ch == '"') {
+                raw = _text.substr(begin, _pos - begin - 1);
+                return true;
+            }
+            if (ch == '\\')
+                ++_pos;
+        }
+        return false;
+    }
+    bool parse_value(std::string_view& raw, bool& is_string) noexcept
+    {
+        skip_spaces();
+        if (_pos >= _text.size())
+            return false;
+        auto ch = _text[_pos];
+        is_string = (ch == '"');
+        if (is_string)
+            return parse_string(raw);
+        if (ch == '{' || ch == '[') {
+            std::size_t depth {};
+            do {
+                skip_spaces();
+                if (_pos >= _text.size())
+                    return false;
+                ch = _text[_pos];
+                if (ch == '"') {
+                    if (!parse_string(raw))
+                        return false;
+                    continue;
+                }
+                if (ch == '{' || ch == '[')
+                    ++depth;
+                else if (ch == '}' || ch == ']')
+                    --depth;
+                ++_pos;
+            } while (depth);
+            raw = {};
+            return true;
+        }
+        auto begin = _pos;
+        while (_pos < _text.size() && std::string_view { ",}] \t\r\n" }.find(_text[_pos]) == std::string_view::npos)
+            ++_pos;
+        raw = _text.substr(begin, _pos - begin);
+        return !raw.empty();
+    }
+    static bool unescape(std::string_view raw, std::string& value)
+    {
+        value.clear();
+        value.reserve(raw.size());
+        for (std::size_t pos {}; pos < raw.size(); ++pos) {
+            auto ch = raw[pos];
+            if (ch == '\\') {
+                if (++pos >= raw.size())
+                    return false;
+                switch (raw[pos]) {
+                case '"':
+                case '\\':
+                case '/':
+                    ch = raw[pos];
+                    break;
+                case 'b':
+                    ch = '\b';
+                    break;
+                case 'f':
+                    ch = '\f';
+                    break;
+                case 'n':
+                    ch = '\n';
+                    break;
+                case 'r':
+                    ch = '\r';
+                    break;
+                case 't':
+                    ch = '\t';
+                    break;
+                default:
+                    // \uXXXX и прочее разбирает общий парсер JSON
+                    return false;
+                }
+            }
+            value.push_back(ch);
+        }
+        return true;
+    }
+
+public:
+    explicit icr_identity_parser(std::string_view text) noexcept
+        : _text { text }
+    {
+    }
+    bool parse(icr_identity& identity)
+    {
+        if (!consume('{'))
+            return false;
+        if (!consume('}')) {
+            do {
+                std::string_view key {}, value {};
+                bool is_string {};
+                if (!parse_string(key) || !consume(':') || !parse_value(value, is_string))
+                    return false;
+                if (auto field = identity.field(key); field) {
+                    if (!is_string)
+                        field->assign(value);
+                    else if (!unescape(value, *field))
+                        return false;
+                }
+            } while (consume(','));
+            if (!consume('}'))
+                return false;
+        }
+        skip_spaces();
+        return _pos == _text.size();
+    }
+};
+
+}
+
+struct icr_carrier_cache::private_data {
+    std::mutex mutex {};
+    std::filesystem::path directory {};
+    std::map<std::string, icr_raw_data> entries {};
+
+    std::filesystem::path filename(const std::string& key) const
+    {
+        return directory / ("icr_" + key + ".bin");
+    }
+};
+
+std::shared_ptr<icr_carrier_cache::private_data> icr_carrier_cache::d_ptr {
+    std::make_shared<icr_carrier_cache::private_data>()
+};
+
+void icr_carrier_cache::set_directory(const std::filesystem::path& directory)
+{
+    if (!directory.empty()) {
+        std::filesystem::create_directories(directory);
+    }
+    std::lock_guard lock { d_ptr->mutex };
+    d_ptr->directory = directory;
+}
+
+std::filesystem::path icr_carrier_cache::get_directory()
+{
+    std::lock_guard lock { d_ptr->mutex };
+    return d_ptr->directory;
+}
+
+void icr_carrier_cache::clear() noexcept
+{
+    std::lock_guard lock { d_ptr->mutex };
+    d_ptr->entries.clear();
+}
+
+bool icr_carrier_cache::load(const std::string& key, icr_raw_data& data)
+{
+    std::lock_guard lock { d_ptr->mutex };
+    if (auto it = d_ptr->entries.find(key); it != d_ptr->entries.end()) {
+        data = it->second;
+        return true;
+    }
+    if (d_ptr->directory.empty()) {
+        return false;
+    }
+    std::ifstream file { d_ptr->filename(key), std::ios::binary };
+    if (!file) {
+        return false;
+    }
+    std::vector<char> content { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+    data.resize(content.size());
+    std::transform(content.cbegin(), content.cend(), data.begin(), [](char ch) { return std::byte(ch); });
+    d_ptr->entries[key] = data;
+    return true;
+}
+
+void icr_carrier_cache::store(const std::string& key, const icr_raw_data& data) noexcept
+try {
+    std::lock_guard lock { d_ptr->mutex };
+    d_ptr->entries[key] = data;
+    if (d_ptr->directory.empty()) {
+        return;
+    }
+    std::ofstream file { d_ptr->filename(key), std::ios::binary | std::ios::trunc };
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+} catch (...) {
+    // кэш необязателен, ошибки записи не влияют на работу ICR
+}
+
+void icr_carrier_cache::erase(const std::string& key) noexcept
+try {
+    std::lock_guard lock { d_ptr->mutex };
+    d_ptr->entries.erase(key);
+    if (!d_ptr->directory.empty()) {
+        std::error_code error {};
+        std::filesystem::remove(d_ptr->filename(key), error);
+    }
+} catch (...) {
+}
+
 struct icr_carrier_impl::private_data {
     ::_93aa66b _93aa66b {};
+    std::string cache_key {}; ///< Ключ кэша ICR (шина.слот), пустой - кэш не используется.
     std::string name {};
     std::string serial {};
     std::string type {};
     std::string version {};
+    std::once_flag executor_once {};
+    std::shared_ptr<bus_executor> executor {}; ///< Исполнитель транзакций платы, создается при первом обращении к ICR.
 };
 
 icr_carrier_impl::icr_carrier_impl(const subsystem_data& data, const icr_carrier_parser& parser)
@@ -52,26 +317,45 @@ icr_carrier_impl::icr_carrier_impl(const subsystem_data& data, const icr_carrier
     if (!d_ptr->_93aa66b) {
         throw icr_carrier_error("_93aa66b chip not found");
     }
+    if (io_locaction carrier_location {}; storage().get(DATA_STORAGE_VALUE_TO_STRING(carrier_location), carrier_location)) {
+        d_ptr->cache_key = std::to_string(carrier_location.bus) + '.' + std::to_string(carrier_location.slot);
+    }
     // чтение и разбор JSON данных
     // TODO: убрать из конструктора в отдельную функцию
     // TODO: при неправильном EEPROM должна быть возможность прописать правильный
     // TODO: ICR подсистема должна быть в любом случае
-    std::stringstream icr_config {};
-    config_parser::tree_type ptree {};
-    for (auto ch : get_raw_data()) {
-        if (ch == std::byte(0))
-            break;
-        icr_config << char(ch);
+    auto icr_data = read_identity_data();
+    auto payload_size = std::find(icr_data.cbegin(), icr_data.cend(), std::byte(0)) - icr_data.cbegin();
+    std::string_view icr_config { reinterpret_cast<const char*>(icr_data.data()), std::size_t(payload_size) };
+    icr_identity identity {};
+    if (!icr_identity_parser { icr_config }.parse(identity)) {
+        // нестандартный JSON разбирается общим парсером
+        identity = {};
+        try {
+            std::istringstream icr_stream { std::string { icr_config } };
+            config_parser::tree_type ptree {};
+            boost::property_tree::read_json(icr_stream, ptree);
+            identity.name = ptree.get<std::string>("name", "undefined");
+            identity.version = ptree.get<std::string>("version", "undefined");
+            identity.type = ptree.get<std::string>("type", "undefined");
+            identity.serial = ptree.get<std::string>("sn", "undefined");
+        } catch (const std::exception& e) {
+            // TODO: не перехватывать, когда вынесем в отдельную функцию
+            printf("[icr] |%s|\n", e.what());
+        }
     }
-    try {
-        boost::property_tree::read_json(icr_config, ptree);
-        d_ptr->name = ptree.get<std::string>("name", "undefined");
-        d_ptr->version = ptree.get<std::string>("version", "undefined");
-        d_ptr->type = ptree.get<std::string>("type", "undefined");
-        d_ptr->serial = ptree.get<std::string>("sn", "undefined");
-    } catch (const std::exception& e) {
-        // TODO: не перехватывать, когда вынесем в отдельную функцию
-        printf("[icr] |%s|\n", e.what());
+    d_ptr->name = std::move(identity.name);
+    d_ptr->version = std::move(identity.version);
+    d_ptr->type = std::move(identity.type);
+    d_ptr->serial = std::move(identity.serial);
+}
+
+icr_carrier_impl::~icr_carrier_impl() noexcept
+{
+    // очередь исполняется по порядку, поэтому после пустой задачи наших задач в ней нет;
+    // если последняя ссылка освобождена задачей исполнителя, ожидание зациклилось бы на ней самой
+    if (d_ptr->executor && !d_ptr->executor->is_current()) {
+        d_ptr->executor->wait();
     }
 }
 
@@ -80,24 +364,155 @@ std::string icr_carrier_impl::get_carrier_serial() const noexcept { return d_ptr
 std::string icr_carrier_impl::get_carrier_type() const noexcept { return d_ptr->type; };
 std::string icr_carrier_impl::get_carrier_version() const noexcept { return d_ptr->version; };
 
-icr_raw_data icr_carrier_impl::get_raw_data() const
+icr_raw_data icr_carrier_impl::read_identity_data() const
+{
+    if (!d_ptr->_93aa66b) {
+        throw icr_carrier_memory_not_found();
+    }
+    icr_raw_data data {};
+    if (!d_ptr->cache_key.empty() && icr_carrier_cache::load(d_ptr->cache_key, data)
+        && verify_raw_data_chip<_93aa66b>(d_ptr->_93aa66b, data)) {
+        log().debug("icr data taken from cache");
+        return data;
+    }
+    data = get_payload_chip<_93aa66b>(d_ptr->_93aa66b);
+    if (!d_ptr->cache_key.empty()) {
+        icr_carrier_cache::store(d_ptr->cache_key, data);
+    }
+    return data;
+}
+
+icr_raw_data icr_carrier_impl::read_raw_data() const
 {
     if (d_ptr->_93aa66b) {
-        return get_raw_data_chip<_93aa66b>(d_ptr->_93aa66b);
+        auto data = get_raw_data_chip<_93aa66b>(d_ptr->_93aa66b);
+        if (!d_ptr->cache_key.empty()) {
+            icr_carrier_cache::store(d_ptr->cache_key, data);
+        }
+        return data;
     } else {
         throw icr_carrier_memory_not_found();
     }
 }
 
-void icr_carrier_impl::set_raw_data(const icr_raw_data& data)
+void icr_carrier_impl::write_raw_data(const icr_raw_data& data)
 {
     if (d_ptr->_93aa66b) {
-        set_raw_data_chip<_93aa66b>(d_ptr->_93aa66b, data);
+        if (!d_ptr->cache_key.empty()) {
+            icr_carrier_cache::erase(d_ptr->cache_key);
+        }
+        set_raw_data_chip<_93aa66b>(d_ptr->_93aa66b, data, false);
     } else {
         throw icr_carrier_memory_not_found();
     }
 }
 
+icr_write_stats icr_carrier_impl::write_raw_data_update(const icr_raw_data& data)
+{
+    if (!d_ptr->_93aa66b) {
+        throw icr_carrier_memory_not_found();
+    }
+    if (!d_ptr->cache_key.empty()) {
+        icr_carrier_cache::erase(d_ptr->cache_key);
+    }
+    auto stats = set_raw_data_chip<_93aa66b>(d_ptr->_93aa66b, data, true);
+    if (!d_ptr->cache_key.empty()) {
+        // после сверки всех слов содержимое микросхемы известно полностью
+        icr_raw_data image(stats.words_total * sizeof(_93aa66b::element_type::value_type));
+        std::copy(data.cbegin(), data.cend(), image.begin());
+        icr_carrier_cache::store(d_ptr->cache_key, image);
+    }
+    log().debug("icr updated: {} of {} words written in {} us", stats.words_written, stats.words_total, stats.elapsed.count());
+    return stats;
+}
+
+const bus_executor& icr_carrier_impl::executor() const
+{
+    std::call_once(d_ptr->executor_once, [this] {
+        d_ptr->executor = bus_executor::get("carrier:" + (d_ptr->cache_key.empty() ? get_name() : d_ptr->cache_key));
+    });
+    return *d_ptr->executor;
+}
+
+///
+/// \brief Синхронное выполнение транзакции через исполнитель платы.
+/// \details Синхронные и асинхронные вызовы идут через одну очередь и не перемешиваются.
+/// Из задачи самого исполнителя транзакция выполняется сразу, иначе ожидание не завершится.
+///
+template <typename function_type>
+auto icr_carrier_impl::execute(function_type&& function) const
+{
+    auto& bus = executor();
+    if (bus.is_current()) {
+        return function();
+    }
+    return bus.submit(std::forward<function_type>(function)).get();
+}
+
+icr_raw_data icr_carrier_impl::get_raw_data() const
+{
+    return execute([this] { return read_raw_data(); });
+}
+
+void icr_carrier_impl::set_raw_data(const icr_raw_data& data)
+{
+    execute([this, &data] { write_raw_data(data); });
+}
+
+icr_write_stats icr_carrier_impl::update_raw_data(const icr_raw_data& data)
+{
+    return execute([this, &data] { return write_raw_data_update(data); });
+}
+
+std::future<icr_raw_data> icr_carrier_impl::get_raw_data_async() const
+{
+    return executor().submit([this] { return read_raw_data(); });
+}
+
+std::future<void> icr_carrier_impl::set_raw_data_async(const icr_raw_data& data)
+{
+    return executor().submit([this, data] { write_raw_data(data); });
+}
+
+std::future<icr_write_stats> icr_carrier_impl::update_raw_data_async(const icr_raw_data& data)
+{
+    return executor().submit([this, data] { return write_raw_data_update(data); });
+}
+
+template <typename chip_type>
+bool icr_carrier_impl::verify_raw_data_chip(chip_type& chip, const icr_raw_data& data) const
+{
+    using vtype = typename chip_type::element_type::value_type;
+    constexpr auto bytes_in_word = sizeof(vtype); // количество байтов в одном слове микросхемы
+    constexpr std::size_t probe_words = 16; // число сверяемых слов в начале и в конце данных
+    auto chip_size_in_word = chip->size(); // размер микросхемы в словах (8, 16, 32 бита)
+
+    // в кэше может быть как полный образ, так и начало данных до завершающего нуля
+    if (data.empty() || data.size() % bytes_in_word || data.size() > chip_size_in_word * bytes_in_word) {
+        return false;
+    }
+    auto data_size_in_word = data.size() / bytes_in_word;
+    auto compare_word = [&](std::size_t addr) {
+        auto value = chip->read(vtype(addr));
+        for (size_t byte_num = 0; byte_num < bytes_in_word; ++byte_num)
+            if (data[addr * bytes_in_word + byte_num] != std::byte(value >> (byte_num << 3)))
+                return false;
+        return true;
+    };
+    // сверяются начало данных и слова перед завершающим нулем, где обычно меняется серийный номер
+    auto payload_end = std::find(data.cbegin(), data.cend(), std::byte(0)) - data.cbegin();
+    auto last_word = std::min<std::size_t>(payload_end / bytes_in_word, data_size_in_word - 1);
+    for (std::size_t addr {}; addr < std::min(probe_words, data_size_in_word); ++addr) {
+        if (!compare_word(addr))
+            return false;
+    }
+    for (auto addr = std::max(probe_words, last_word + 1 - std::min(last_word + 1, probe_words)); addr <= last_word; ++addr) {
+        if (!compare_word(addr))
+            return false;
+    }
+    return true;
+}
+
 template <typename chip_type>
 icr_raw_data icr_carrier_impl::get_raw_data_chip(chip_type& chip) const
 {
@@ -115,7 +530,30 @@ icr_raw_data icr_carrier_impl::get_raw_data_chip(chip_type& chip) const
 }
 
 template <typename chip_type>
-void icr_carrier_impl::set_raw_data_chip(chip_type& chip, const icr_raw_data& data)
+icr_raw_data icr_carrier_impl::get_payload_chip(chip_type& chip) const
+{
+    using vtype = typename chip_type::element_type::value_type;
+    constexpr auto bytes_in_word = sizeof(vtype); // количество байтов в одном слове микросхемы
+    auto chip_size_in_word = chip->size(); // размер микросхемы в словах (8, 16, 32 бита)
+    icr_raw_data result {};
+
+    // чтение прекращается на слове с завершающим нулем
+    for (vtype addr {}; addr < chip_size_in_word; ++addr) {
+        auto value = chip->read(addr);
+        bool terminated {};
+        for (size_t byte_num = 0; byte_num < bytes_in_word; ++byte_num) {
+            auto byte = std::byte(value >> (byte_num << 3));
+            terminated |= (byte == std::byte(0));
+            result.push_back(byte);
+        }
+        if (terminated)
+            break;
+    }
+    return result;
+}
+
+template <typename chip_type>
+icr_write_stats icr_carrier_impl::set_raw_data_chip(chip_type& chip, const icr_raw_data& data, bool differential)
 {
     using vtype = typename chip_type::element_type::value_type;
     constexpr auto bytes_in_word = sizeof(vtype); // количество байтов в одном слове микросхемы
@@ -126,13 +564,21 @@ void icr_carrier_impl::set_raw_data_chip(chip_type& chip, const icr_raw_data& da
         throw icr_carrier_error("the size of the data is larger than the size of the ICR");
 
     icr_raw_data new_data { chip_size_in_bytes };
-    if (data.size() < chip_size_in_bytes)
-        std::copy(data.cbegin(), data.cend(), new_data.begin());
+    std::copy(data.cbegin(), data.cend(), new_data.begin());
 
+    icr_write_stats stats {};
+    stats.words_total = chip_size_in_word;
+    auto start = std::chrono::steady_clock::now();
     for (vtype addr {}; addr < chip_size_in_word; ++addr) {
         vtype value {};
         for (size_t byte_num = 0; byte_num < bytes_in_word; ++byte_num)
             value |= size_t(new_data[addr * bytes_in_word + byte_num]) << (byte_num << 3);
+        // чтение слова много быстрее цикла записи EEPROM, совпадающие слова не перезаписываются
+        if (differential && chip->read(addr) == value)
+            continue;
         chip->write(addr, value);
+        ++stats.words_written;
     }
+    stats.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    return stats;
 }
@@ -2,6 +2,7 @@
 
 #include "nebulaxi/subsystems/icr_carrier.hpp"
 
+#include "bus_executor.hxx"
 #include "subsystems/subsystem_base.hxx"
 
 namespace insys::nebulaxi {
@@ -22,6 +23,7 @@ public:
     inline static const char* type { NEBULAXI_TYPE_TO_STR(icr_carrier) };
 
     icr_carrier_impl(const subsystem_data&, const icr_carrier_parser&);
+    ~icr_carrier_impl() noexcept;
 
 private:
     std::string get_carrier_name() const noexcept final;
@@ -31,11 +33,29 @@ private:
 
     icr_raw_data get_raw_data() const final;
     void set_raw_data(const icr_raw_data&) final;
+    icr_write_stats update_raw_data(const icr_raw_data&) final;
+    std::future<icr_raw_data> get_raw_data_async() const final;
+    std::future<void> set_raw_data_async(const icr_raw_data&) final;
+    std::future<icr_write_stats> update_raw_data_async(const icr_raw_data&) final;
+
+    const bus_executor& executor() const;
+    template <typename function_type>
+    auto execute(function_type&& function) const;
+
+    icr_raw_data read_raw_data() const;
+    void write_raw_data(const icr_raw_data&);
+    icr_write_stats write_raw_data_update(const icr_raw_data&);
+
+    icr_raw_data read_identity_data() const;
 
     template <typename chip_type>
     icr_raw_data get_raw_data_chip(chip_type& chip) const;
     template <typename chip_type>
-    void set_raw_data_chip(chip_type& chip, const icr_raw_data& data);
+    icr_raw_data get_payload_chip(chip_type& chip) const;
+    template <typename chip_type>
+    bool verify_raw_data_chip(chip_type& chip, const icr_raw_data& data) const;
+    template <typename chip_type>
+    icr_write_stats set_raw_data_chip(chip_type& chip, const icr_raw_data& data, bool differential);
 };
 
 }
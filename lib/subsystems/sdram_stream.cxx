@@ -0,0 +1,266 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "subsystems/sdram_stream.hxx"
+
+using namespace std::chrono_literals;
+
+using namespace insys::nebulaxi;
+
+sdram_stream_error::sdram_stream_error(const std::string& message)
+    : subsystem_error(message, "[sdram_stream_error]: ")
+{
+}
+
+namespace {
+
+///
+/// \brief Программная модель контроллера SDRAM для режима симуляции.
+/// \details SDRAM - массив в памяти, операции выполняются в отдельном потоке через те же кольца DMA,
+/// входной поток при записи - возрастающие 64-битные слова.
+///
+class sdram_simulate_device final : public sdram_device_interface {
+    std::vector<std::byte> _memory {};
+    std::shared_ptr<dma_ring> _h2c {};
+    std::shared_ptr<dma_ring> _c2h {};
+    std::future<void> _operation {};
+    std::atomic<bool> _abort {};
+
+    void write(std::size_t offset, std::size_t size)
+    {
+        for (std::size_t position {}; position < size && !_abort;) {
+            auto buffer = _h2c->acquire_filled(10ms);
+            if (!buffer) {
+                continue;
+            }
+            auto count = std::min(buffer->used, size - position);
+            std::memcpy(_memory.data() + offset + position, buffer->data, count);
+            position += count;
+            _h2c->release(buffer);
+        }
+    }
+    void read(std::size_t offset, std::size_t size)
+    {
+        for (std::size_t position {}; position < size && !_abort;) {
+            auto buffer = _c2h->acquire_free(10ms);
+            if (!buffer) {
+                continue;
+            }
+            auto count = std::min(buffer->size, size - position);
+            std::memcpy(buffer->data, _memory.data() + offset + position, count);
+            position += count;
+            _c2h->commit(buffer, count);
+        }
+    }
+    void record(std::size_t offset, std::size_t size)
+    {
+        uint64_t counter {};
+        for (std::size_t position {}; position < size && !_abort; position += sizeof(counter), ++counter) {
+            std::memcpy(_memory.data() + offset + position, &counter, std::min(sizeof(counter), size - position));
+        }
+    }
+
+public:
+    sdram_simulate_device(std::size_t capacity, std::shared_ptr<dma_ring> h2c, std::shared_ptr<dma_ring> c2h)
+        : _memory(capacity)
+        , _h2c { std::move(h2c) }
+        , _c2h { std::move(c2h) }
+    {
+    }
+    ~sdram_simulate_device() noexcept { abort(); }
+    std::size_t capacity() const final { return _memory.size(); }
+    void start(sdram_op op, std::size_t offset, std::size_t size) final
+    {
+        _abort = false;
+        _operation = std::async(std::launch::async, [this, op, offset, size] {
+            switch (op) {
+            case sdram_op::write:
+                write(offset, size);
+                break;
+            case sdram_op::read:
+                read(offset, size);
+                break;
+            case sdram_op::record:
+                record(offset, size);
+                break;
+            case sdram_op::idle:
+                break;
+            }
+        });
+    }
+    bool wait(std::chrono::milliseconds timeout) final
+    {
+        if (!_operation.valid()) {
+            return true;
+        }
+        if (_operation.wait_for(timeout) != std::future_status::ready) {
+            return false;
+        }
+        _operation.get();
+        return true;
+    }
+    void abort() noexcept final
+    {
+        _abort = true;
+        if (_operation.valid()) {
+            _operation.wait();
+        }
+    }
+};
+
+}
+
+struct sdram_stream_impl::private_data {
+    std::shared_ptr<dma_ring> h2c {}; ///< Кольцо загрузки в SDRAM.
+    std::shared_ptr<dma_ring> c2h {}; ///< Кольцо выгрузки из SDRAM.
+    std::unique_ptr<sdram_device_interface> device {};
+    std::chrono::milliseconds timeout {};
+    std::mutex mutex {}; ///< Одна операция в каждый момент времени.
+    /// Статистика последней передачи, читается без ожидания текущей операции (std::atomic_load).
+    std::shared_ptr<const sdram_stream_stats> stats { std::make_shared<const sdram_stream_stats>() };
+};
+
+sdram_stream_impl::sdram_stream_impl(const subsystem_data& data, const sdram_stream_parser& parser)
+    : subsystem_base(data)
+    , d_ptr { std::make_shared<private_data>() }
+{
+    d_ptr->h2c = std::make_shared<dma_ring>(parser.get_buffer_size(), std::max<std::size_t>(parser.get_buffers(), 2));
+    d_ptr->c2h = std::make_shared<dma_ring>(parser.get_buffer_size(), std::max<std::size_t>(parser.get_buffers(), 2));
+    d_ptr->timeout = parser.get_timeout();
+    d_ptr->device = std::make_unique<sdram_simulate_device>(parser.get_simulate_capacity(), d_ptr->h2c, d_ptr->c2h);
+}
+
+sdram_stream_impl::~sdram_stream_impl() noexcept
+{
+    d_ptr->device->abort();
+}
+
+void sdram_stream_impl::reset()
+{
+    std::lock_guard lock { d_ptr->mutex };
+    d_ptr->device->abort();
+    d_ptr->h2c->reset();
+    d_ptr->c2h->reset();
+    std::atomic_store(&d_ptr->stats, std::make_shared<const sdram_stream_stats>());
+}
+
+std::size_t sdram_stream_impl::get_capacity() const
+{
+    return d_ptr->device->capacity();
+}
+
+void sdram_stream_impl::check_range(std::size_t size, std::size_t offset) const
+{
+    // контроллер адресует SDRAM 32-битными смещением и размером
+    if (!size || offset > UINT32_MAX || size > UINT32_MAX || offset + size > get_capacity()) {
+        throw sdram_stream_error("transfer is out of SDRAM range");
+    }
+}
+
+void sdram_stream_impl::start(sdram_op op, std::size_t offset, std::size_t size) const
+{
+    d_ptr->device->abort();
+    d_ptr->h2c->reset();
+    d_ptr->c2h->reset();
+    d_ptr->device->start(op, offset, size);
+}
+
+sdram_stream_stats sdram_stream_impl::finish(std::chrono::steady_clock::time_point start, uint64_t bytes, const dma_ring& ring) const
+{
+    if (!d_ptr->device->wait(d_ptr->timeout)) {
+        d_ptr->device->abort();
+        throw sdram_stream_error("SDRAM operation timeout");
+    }
+    sdram_stream_stats stats {};
+    stats.bytes = bytes;
+    stats.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    stats.bandwidth = stats.elapsed.count() ? bytes * 1e6 / stats.elapsed.count() : 0.;
+    auto ring_stats = ring.get_stats();
+    stats.stalls = ring_stats.producer_stalls + ring_stats.consumer_stalls;
+    std::atomic_store(&d_ptr->stats, std::make_shared<const sdram_stream_stats>(stats));
+    log().debug("sdram transfer: {} bytes in {} us", stats.bytes, stats.elapsed.count());
+    return stats;
+}
+
+sdram_stream_stats sdram_stream_impl::upload(const std::byte* data, std::size_t size, std::size_t offset)
+{
+    std::lock_guard lock { d_ptr->mutex };
+    check_range(size, offset);
+    auto& ring = *d_ptr->h2c;
+    auto started = std::chrono::steady_clock::now();
+    start(sdram_op::write, offset, size);
+    // пока движок передает заполненный буфер, хост заполняет следующий
+    for (std::size_t position {}; position < size;) {
+        auto buffer = ring.acquire_free(d_ptr->timeout);
+        if (!buffer) {
+            d_ptr->device->abort();
+            throw sdram_stream_error("upload timeout");
+        }
+        auto count = std::min(buffer->size, size - position);
+        std::memcpy(buffer->data, data + position, count);
+        ring.commit(buffer, count);
+        position += count;
+    }
+    return finish(started, size, ring);
+}
+
+sdram_stream_stats sdram_stream_impl::download(std::byte* data, std::size_t size, std::size_t offset)
+{
+    std::size_t position {};
+    return drain([data, &position](const std::byte* buffer, std::size_t count) {
+        std::memcpy(data + position, buffer, count);
+        position += count;
+    },
+        size, offset);
+}
+
+sdram_stream_stats sdram_stream_impl::drain(const std::function<void(const std::byte*, std::size_t)>& consumer,
+    std::size_t size, std::size_t offset)
+{
+    std::lock_guard lock { d_ptr->mutex };
+    check_range(size, offset);
+    auto& ring = *d_ptr->c2h;
+    auto started = std::chrono::steady_clock::now();
+    start(sdram_op::read, offset, size);
+    for (std::size_t position {}; position < size;) {
+        auto buffer = ring.acquire_filled(d_ptr->timeout);
+        if (!buffer) {
+            d_ptr->device->abort();
+            throw sdram_stream_error("download timeout");
+        }
+        try {
+            consumer(buffer->data, buffer->used);
+        } catch (...) {
+            ring.release(buffer);
+            d_ptr->device->abort();
+            throw;
+        }
+        position += buffer->used;
+        ring.release(buffer);
+    }
+    return finish(started, size, ring);
+}
+
+void sdram_stream_impl::record(std::size_t size, std::size_t offset)
+{
+    std::lock_guard lock { d_ptr->mutex };
+    check_range(size, offset);
+    start(sdram_op::record, offset, size);
+}
+
+bool sdram_stream_impl::wait_recorded(std::chrono::milliseconds timeout)
+{
+    std::lock_guard lock { d_ptr->mutex };
+    return d_ptr->device->wait(timeout);
+}
+
+sdram_stream_stats sdram_stream_impl::get_stats() const noexcept
+{
+    return *std::atomic_load(&d_ptr->stats);
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <chrono>
+
+#include "nebulaxi/subsystems/dma_ring.hpp"
+#include "nebulaxi/subsystems/sdram_stream.hpp"
+
+#include "subsystems/subsystem_base.hxx"
+
+namespace insys::nebulaxi {
+
+class sdram_stream_parser final : public subsystem_parser {
+
+public:
+    using subsystem_parser::subsystem_parser;
+    auto get_simulate_capacity() const
+    {
+        return m_ptree.get_optional<std::size_t>("simulate_capacity_mb").get_value_or(64) << 20;
+    }
+    auto get_buffer_size() const
+    {
+        return m_ptree.get_optional<std::size_t>("buffer_size").get_value_or(1 << 20);
+    }
+    auto get_buffers() const
+    {
+        return m_ptree.get_optional<std::size_t>("buffers").get_value_or(2);
+    }
+    auto get_timeout() const
+    {
+        return std::chrono::milliseconds(m_ptree.get_optional<std::size_t>("timeout").get_value_or(2000));
+    }
+};
+
+///
+/// \brief Операция контроллера SDRAM.
+///
+///
+enum class sdram_op : uint32_t {
+    idle = 0, ///< Нет операции.
+    write = 1, ///< Запись из потока H2C в SDRAM.
+    read = 2, ///< Чтение из SDRAM в поток C2H.
+    record = 3 ///< Запись входного потока платы в SDRAM.
+};
+
+///
+/// \brief Контроллер SDRAM: управление операцией и перенос данных между SDRAM и кольцами DMA.
+/// \details Пока есть только программная модель: карта регистров контроллера и движок DMA
+/// юнитов axis_fifo не описаны, поэтому подсистема создается только для simulate-носителей.
+///
+struct sdram_device_interface {
+    virtual std::size_t capacity() const = 0;
+    virtual void start(sdram_op op, std::size_t offset, std::size_t size) = 0;
+    ///
+    /// \brief Ожидание окончания операции, ошибки операции передаются исключением.
+    ///
+    virtual bool wait(std::chrono::milliseconds timeout) = 0;
+    virtual void abort() noexcept = 0;
+    virtual ~sdram_device_interface() noexcept = default;
+};
+
+class sdram_stream_impl final : public sdram_stream_interface,
+                                public subsystem_base<sdram_stream_impl> {
+    struct private_data;
+    std::shared_ptr<private_data> d_ptr {};
+
+public:
+    using interface_type = sdram_stream_interface;
+    inline static const char* type { NEBULAXI_TYPE_TO_STR(sdram_stream) };
+
+    sdram_stream_impl(const subsystem_data&, const sdram_stream_parser&);
+    ~sdram_stream_impl() noexcept;
+
+private:
+    void reset() final;
+    std::size_t get_capacity() const final;
+    sdram_stream_stats upload(const std::byte*, std::size_t, std::size_t) final;
+    sdram_stream_stats download(std::byte*, std::size_t, std::size_t) final;
+    sdram_stream_stats drain(const std::function<void(const std::byte*, std::size_t)>&, std::size_t, std::size_t) final;
+    void record(std::size_t, std::size_t) final;
+    bool wait_recorded(std::chrono::milliseconds) final;
+    sdram_stream_stats get_stats() const noexcept final;
+
+    void check_range(std::size_t, std::size_t) const;
+    void start(sdram_op, std::size_t, std::size_t) const;
+    sdram_stream_stats finish(std::chrono::steady_clock::time_point, uint64_t, const dma_ring&) const;
+};
+
+}
@@ -73,6 +73,21 @@ protected:
         reg.write(axi_field_type::offset, reg_value.set_field(value));
     }
 
+    template <typename... axi_field_types>
+    static void reg_fields_write(const reg_interface &reg, reg_field_value<axi_field_types>... values)
+    {
+        insys::nebulaxi::reg_fields_write<axi_field_types...>(
+            [&reg](std::size_t offset) { return reg.read(offset); },
+            [&reg](std::size_t offset, uint32_t value) { reg.write(offset, value); },
+            values...);
+    }
+
+    template <typename... axi_field_types>
+    static auto reg_fields_read(const reg_interface &reg)
+    {
+        return insys::nebulaxi::reg_fields_read<axi_field_types...>([&reg](std::size_t offset) { return reg.read(offset); });
+    }
+
 public:
     static bool is_same_type(const std::string& type) noexcept
     {
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "nebulaxi/nebulaxi_types.hpp"
+
+namespace insys::nebulaxi {
+
+namespace detail {
+
+    ///
+    /// \brief Маска битов, занимаемых типом в регистре: поле - его биты, регистр - все 32 бита.
+    ///
+    template <typename reg_type, typename = void>
+    inline constexpr uint32_t reg_map_mask { UINT32_MAX };
+    template <typename reg_type>
+    inline constexpr uint32_t reg_map_mask<reg_type, std::void_t<decltype(reg_type::bit_mask)>> { uint32_t(reg_type::bit_mask) };
+
+    template <std::size_t count>
+    constexpr std::array<std::size_t, count> reg_map_sort(std::array<std::size_t, count> offsets)
+    {
+        for (std::size_t i = 1; i < count; ++i) {
+            for (std::size_t j = i; j > 0 && offsets[j - 1] > offsets[j]; --j) {
+                auto offset = offsets[j];
+                offsets[j] = offsets[j - 1];
+                offsets[j - 1] = offset;
+            }
+        }
+        return offsets;
+    }
+
+    template <std::size_t count>
+    constexpr std::size_t reg_map_unique_count(const std::array<std::size_t, count>& sorted)
+    {
+        std::size_t result {};
+        for (std::size_t i = 0; i < count; ++i) {
+            if (i == 0 || sorted[i] != sorted[i - 1])
+                ++result;
+        }
+        return result;
+    }
+
+    template <std::size_t size, std::size_t count>
+    constexpr std::array<std::size_t, size> reg_map_unique(const std::array<std::size_t, count>& sorted)
+    {
+        std::array<std::size_t, size> result {};
+        std::size_t index {};
+        for (std::size_t i = 0; i < count; ++i) {
+            if (i == 0 || sorted[i] != sorted[i - 1])
+                result[index++] = sorted[i];
+        }
+        return result;
+    }
+
+    template <std::size_t size>
+    constexpr std::size_t reg_map_index(const std::array<std::size_t, size>& offsets, std::size_t offset)
+    {
+        for (std::size_t i = 0; i < size; ++i) {
+            if (offsets[i] == offset)
+                return i;
+        }
+        return size;
+    }
+
+    ///
+    /// \brief Порядок записи: индексы отсортированных смещений в порядке первого объявления.
+    ///
+    template <std::size_t size, std::size_t count>
+    constexpr std::array<std::size_t, size> reg_map_write_order(
+        const std::array<std::size_t, count>& declared, const std::array<std::size_t, size>& offsets)
+    {
+        std::array<std::size_t, size> result {};
+        std::size_t index {};
+        for (std::size_t i = 0; i < count; ++i) {
+            if (reg_map_index(declared, declared[i]) == i)
+                result[index++] = reg_map_index(offsets, declared[i]);
+        }
+        return result;
+    }
+
+}
+
+///
+/// \brief Карта группы регистров, вычисляемая на этапе компиляции.
+/// \details Регистры и битовые поля задаются типами (axi_reg, axi_field), повторяющиеся смещения
+/// объединяются: поля одного регистра читаются и записываются одним обращением. Чтение выполняется
+/// по возрастанию смещений, запись - в порядке объявления.
+///
+/// \tparam reg_types типы регистров или битовых полей группы.
+///
+template <typename... reg_types>
+class reg_map final {
+    static constexpr std::array<std::size_t, sizeof...(reg_types)> declared { reg_types::offset... };
+    static constexpr auto sorted = detail::reg_map_sort(declared);
+
+public:
+    static constexpr std::size_t size { detail::reg_map_unique_count(sorted) };
+    static constexpr std::array<std::size_t, size> offsets { detail::reg_map_unique<size>(sorted) };
+    static constexpr std::array<std::size_t, size> write_order { detail::reg_map_write_order(declared, offsets) };
+
+    template <typename reg_type>
+    static constexpr std::size_t index_of() noexcept
+    {
+        constexpr auto index = detail::reg_map_index(offsets, reg_type::offset);
+        static_assert(index < size, "register is not part of the map");
+        return index;
+    }
+};
+
+///
+/// \brief Значения группы регистров карты map_type.
+/// \details Для каждого регистра хранятся известные биты (прочитанные или заданные) и биты,
+/// заданные через set. При записи регистры без заданных битов пропускаются, а регистры,
+/// известные не полностью, перечитываются и записываются с сохранением остальных битов.
+///
+/// \tparam map_type карта регистров (reg_map).
+///
+template <typename map_type>
+class reg_map_values final {
+    std::array<uint32_t, map_type::size> _values {};
+    std::array<uint32_t, map_type::size> _known {}; ///< Биты с известным значением.
+    std::array<uint32_t, map_type::size> _dirty {}; ///< Биты, заданные через set.
+
+public:
+    template <typename reg_type>
+    constexpr reg_type get() const noexcept
+    {
+        return reg_type { _values[map_type::template index_of<reg_type>()] };
+    }
+    ///
+    /// \brief Задание регистра или поля, остальные биты регистра не изменяются.
+    ///
+    template <typename reg_type>
+    constexpr reg_map_values& set(const reg_type& reg) noexcept
+    {
+        constexpr auto index = map_type::template index_of<reg_type>();
+        constexpr auto mask = detail::reg_map_mask<reg_type>;
+        _values[index] = (_values[index] & ~mask) | (uint32_t(reg) & mask);
+        _known[index] |= mask;
+        _dirty[index] |= mask;
+        return *this;
+    }
+    ///
+    /// \brief Пакет чтения: все регистры по возрастанию смещений.
+    ///
+    static auto read_batch() noexcept
+    {
+        std::array<reg_transfer, map_type::size> batch {};
+        for (std::size_t i = 0; i < map_type::size; ++i) {
+            batch[i].offset = map_type::offsets[i];
+        }
+        return batch;
+    }
+    ///
+    /// \brief Загрузка прочитанных значений, заданные через set биты сохраняются.
+    ///
+    void load(const std::array<reg_transfer, map_type::size>& batch) noexcept
+    {
+        for (std::size_t i = 0; i < map_type::size; ++i) {
+            _values[i] = (batch[i].value & ~_dirty[i]) | (_values[i] & _dirty[i]);
+            _known[i] = UINT32_MAX;
+        }
+    }
+    ///
+    /// \brief Пакет чтения перед записью: измененные регистры, известные не полностью.
+    ///
+    reg_batch modify_batch() const
+    {
+        reg_batch batch {};
+        for (std::size_t i = 0; i < map_type::size; ++i) {
+            if (_dirty[i] && _known[i] != UINT32_MAX) {
+                batch.push_back({ map_type::offsets[i], 0, reg_op::read });
+            }
+        }
+        return batch;
+    }
+    ///
+    /// \brief Пакет записи: измененные регистры в порядке объявления.
+    ///
+    /// \param read Результат чтения пакета modify_batch.
+    ///
+    reg_batch write_batch(const reg_batch& read) const
+    {
+        reg_batch batch {};
+        for (auto index : map_type::write_order) {
+            if (!_dirty[index]) {
+                continue;
+            }
+            auto value = _values[index];
+            for (auto& transfer : read) {
+                if (transfer.offset == map_type::offsets[index]) {
+                    value = (transfer.value & ~_known[index]) | (value & _known[index]);
+                }
+            }
+            batch.push_back({ map_type::offsets[index], value, reg_op::write });
+        }
+        return batch;
+    }
+};
+
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "nebulaxi/units/unit.hpp"
+
+namespace insys::nebulaxi {
+
+///
+/// \brief Политика кэширования регистра.
+///
+///
+enum class reg_cache_policy {
+    volatile_reg, ///< Регистр состояния, всегда читается с шины.
+    cached, ///< Управляющий регистр, значение кэшируется при чтении и записи.
+    write_only ///< Регистр только для записи, чтение возвращает последнее записанное значение.
+};
+
+///
+/// \brief Описание кэширования регистра.
+///
+///
+struct reg_cache_config {
+    std::size_t offset {}; ///< Смещение регистра.
+    reg_cache_policy policy { reg_cache_policy::volatile_reg }; ///< Политика кэширования.
+    uint32_t reset_value {}; ///< Значение после сброса (для регистров только для записи).
+};
+
+inline reg_cache_policy reg_cache_policy_from_string(const std::string& policy)
+{
+    if (policy == "cached")
+        return reg_cache_policy::cached;
+    if (policy == "write_only")
+        return reg_cache_policy::write_only;
+    if (policy == "volatile")
+        return reg_cache_policy::volatile_reg;
+    throw unit_error("unknown register cache policy [" + policy + "]");
+}
+
+///
+/// \brief Теневые копии регистров юнита.
+/// \details Кэшируются только явно объявленные регистры, без объявлений кэш не используется.
+///
+///
+class reg_shadow final {
+    struct entry {
+        reg_cache_config config {};
+        uint32_t value {};
+        bool valid {};
+        std::size_t generation {}; ///< Увеличивается при каждой записи и сбросе.
+    };
+    mutable std::mutex _mutex {};
+    std::unordered_map<std::size_t, entry> _regs {};
+    std::atomic<bool> _enabled {};
+    std::atomic<std::size_t> _hits {};
+    std::atomic<std::size_t> _misses {};
+
+    static void reset_entry(entry& reg) noexcept
+    {
+        ++reg.generation;
+        reg.valid = (reg.config.policy == reg_cache_policy::write_only);
+        reg.value = reg.valid ? reg.config.reset_value : 0;
+    }
+
+public:
+    bool enabled() const noexcept { return _enabled.load(std::memory_order_relaxed); }
+    ///
+    /// \brief Объявление политики кэширования регистра.
+    ///
+    void declare(const reg_cache_config& config)
+    {
+        std::lock_guard lock { _mutex };
+        auto& reg = _regs[config.offset];
+        reg.config = config;
+        reset_entry(reg);
+        _enabled.store(true, std::memory_order_relaxed);
+    }
+    ///
+    /// \brief Чтение теневой копии.
+    ///
+    /// \param[out] generation Поколение записи на момент промаха, передается в fill.
+    /// \return \retval true значение взято из кэша \retval false регистр нужно прочитать с шины.
+    ///
+    bool read(std::size_t offset, uint32_t& value, std::size_t& generation)
+    {
+        std::lock_guard lock { _mutex };
+        auto it = _regs.find(offset);
+        if (it == _regs.end() || it->second.config.policy == reg_cache_policy::volatile_reg) {
+            return false;
+        }
+        if (!it->second.valid) {
+            _misses.fetch_add(1, std::memory_order_relaxed);
+            generation = it->second.generation;
+            return false;
+        }
+        _hits.fetch_add(1, std::memory_order_relaxed);
+        value = it->second.value;
+        return true;
+    }
+    ///
+    /// \brief Обновление теневой копии после записи в регистр.
+    ///
+    void update(std::size_t offset, uint32_t value)
+    {
+        std::lock_guard lock { _mutex };
+        auto it = _regs.find(offset);
+        if (it == _regs.end() || it->second.config.policy == reg_cache_policy::volatile_reg) {
+            return;
+        }
+        ++it->second.generation;
+        it->second.value = value;
+        it->second.valid = true;
+    }
+    ///
+    /// \brief Заполнение теневой копии значением, прочитанным с шины после промаха.
+    /// \details Значение отбрасывается, если между промахом и заполнением была запись или сброс.
+    ///
+    /// \param generation Поколение, полученное от read при промахе.
+    ///
+    void fill(std::size_t offset, uint32_t value, std::size_t generation)
+    {
+        std::lock_guard lock { _mutex };
+        auto it = _regs.find(offset);
+        if (it == _regs.end() || it->second.config.policy == reg_cache_policy::volatile_reg
+            || it->second.generation != generation) {
+            return;
+        }
+        it->second.value = value;
+        it->second.valid = true;
+    }
+    ///
+    /// \brief Сброс теневых копий (например, после сброса юнита).
+    ///
+    void invalidate()
+    {
+        std::lock_guard lock { _mutex };
+        for (auto& [offset, reg] : _regs) {
+            reset_entry(reg);
+        }
+    }
+    ///
+    /// \brief Перечитывание кэшируемых регистров с шины.
+    ///
+    /// \param read Функция чтения регистра по смещению.
+    ///
+    template <typename read_function>
+    void resync(read_function&& read)
+    {
+        std::lock_guard lock { _mutex };
+        for (auto& [offset, reg] : _regs) {
+            if (reg.config.policy == reg_cache_policy::cached) {
+                reg.value = read(offset);
+                reg.valid = true;
+                ++reg.generation;
+            }
+        }
+    }
+    reg_cache_stats stats() const noexcept
+    {
+        return { _hits.load(std::memory_order_relaxed), _misses.load(std::memory_order_relaxed) };
+    }
+};
+
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+
+#include "nebulaxi/nebulaxi_types.hpp"
+#include "nebulaxi/units/unit.hpp"
+
+namespace insys::nebulaxi {
+
+///
+/// \brief Счетчики обращений юнита к регистрам по шине.
+/// \details Таблица фиксированного размера с открытой адресацией, без блокировок: смещение
+/// занимает ячейку при первом обращении, счетчики обновляются relaxed-атомиками.
+/// Смещения, не поместившиеся в таблицу, учитываются в общей ячейке. Ячейки выровнены по строке
+/// кэша, чтобы обращения к соседним регистрам из разных потоков не делили одну строку.
+/// Счетчики общие для всех потоков, а не потоковые: обращения к юниту и так сериализуются шиной,
+/// а потоковые копии умножили бы память таблицы на число потоков.
+///
+///
+class reg_stats final {
+public:
+    static constexpr std::size_t capacity { 64 };
+    static constexpr std::size_t overflow_offset { SIZE_MAX };
+
+private:
+    struct alignas(64) slot {
+        std::atomic<std::size_t> offset { overflow_offset };
+        std::atomic<uint64_t> reads {};
+        std::atomic<uint64_t> writes {};
+        std::atomic<uint64_t> read_time {};
+        std::atomic<uint64_t> write_time {};
+        std::array<std::atomic<uint64_t>, reg_latency_buckets> latency {};
+    };
+    std::array<slot, capacity> _slots {};
+    slot _overflow {};
+
+    static std::size_t bucket(uint64_t nanoseconds) noexcept
+    {
+        std::size_t index {};
+        for (; nanoseconds != 0 && index + 1 < reg_latency_buckets; nanoseconds >>= 1) {
+            ++index;
+        }
+        return index;
+    }
+    slot& find(std::size_t offset) noexcept
+    {
+        auto start = (offset / sizeof(uint32_t)) % capacity;
+        for (std::size_t probe {}; probe < capacity; ++probe) {
+            auto& current = _slots[(start + probe) % capacity];
+            auto key = current.offset.load(std::memory_order_acquire);
+            if (key == offset) {
+                return current;
+            }
+            if (key == overflow_offset
+                && (current.offset.compare_exchange_strong(key, offset, std::memory_order_acq_rel) || key == offset)) {
+                return current;
+            }
+        }
+        return _overflow;
+    }
+    static void clear(slot& current) noexcept
+    {
+        current.reads.store(0, std::memory_order_relaxed);
+        current.writes.store(0, std::memory_order_relaxed);
+        current.read_time.store(0, std::memory_order_relaxed);
+        current.write_time.store(0, std::memory_order_relaxed);
+        for (auto& count : current.latency) {
+            count.store(0, std::memory_order_relaxed);
+        }
+    }
+    static bool snapshot(const slot& current, std::size_t offset, reg_access_stats& stats) noexcept
+    {
+        stats.offset = offset;
+        stats.reads = current.reads.load(std::memory_order_relaxed);
+        stats.writes = current.writes.load(std::memory_order_relaxed);
+        stats.read_time = std::chrono::nanoseconds(current.read_time.load(std::memory_order_relaxed));
+        stats.write_time = std::chrono::nanoseconds(current.write_time.load(std::memory_order_relaxed));
+        for (std::size_t i = 0; i < reg_latency_buckets; ++i) {
+            stats.latency[i] = current.latency[i].load(std::memory_order_relaxed);
+        }
+        return stats.reads != 0 || stats.writes != 0;
+    }
+
+public:
+    ///
+    /// \brief Учет одного обращения к регистру.
+    ///
+    void record(std::size_t offset, reg_op op, std::chrono::nanoseconds elapsed) noexcept
+    {
+        auto& current = find(offset);
+        auto nanoseconds = uint64_t(std::max<std::chrono::nanoseconds::rep>(elapsed.count(), 0));
+        if (op == reg_op::read) {
+            current.reads.fetch_add(1, std::memory_order_relaxed);
+            current.read_time.fetch_add(nanoseconds, std::memory_order_relaxed);
+        } else {
+            current.writes.fetch_add(1, std::memory_order_relaxed);
+            current.write_time.fetch_add(nanoseconds, std::memory_order_relaxed);
+        }
+        current.latency[bucket(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    }
+    ///
+    /// \brief Копия счетчиков регистров, к которым были обращения.
+    ///
+    reg_access_stats_list get() const
+    {
+        reg_access_stats_list list {};
+        reg_access_stats stats {};
+        for (auto& current : _slots) {
+            auto offset = current.offset.load(std::memory_order_acquire);
+            if (offset != overflow_offset && snapshot(current, offset, stats)) {
+                list.push_back(stats);
+            }
+        }
+        std::sort(list.begin(), list.end(), [](auto& left, auto& right) { return left.offset < right.offset; });
+        if (snapshot(_overflow, overflow_offset, stats)) {
+            list.push_back(stats);
+        }
+        return list;
+    }
+    ///
+    /// \brief Обнуление счетчиков, занятые ячейки сохраняются.
+    ///
+    void reset() noexcept
+    {
+        for (auto& current : _slots) {
+            clear(current);
+        }
+        clear(_overflow);
+    }
+
+    ///
+    /// \brief Замер длительности обращения, учитывается при выходе из области видимости.
+    /// \details Обращение, завершившееся исключением, не учитывается.
+    ///
+    class scope final {
+        reg_stats& _stats;
+        std::size_t _offset {};
+        reg_op _op {};
+        int _exceptions { std::uncaught_exceptions() };
+        std::chrono::steady_clock::time_point _start { std::chrono::steady_clock::now() };
+
+    public:
+        scope(reg_stats& stats, std::size_t offset, reg_op op) noexcept
+            : _stats { stats }
+            , _offset { offset }
+            , _op { op }
+        {
+        }
+        scope(const scope&) = delete;
+        scope& operator=(const scope&) = delete;
+        ~scope() noexcept
+        {
+            if (std::uncaught_exceptions() > _exceptions) {
+                return;
+            }
+            _stats.record(_offset, _op, std::chrono::steady_clock::now() - _start);
+        }
+    };
+};
+
+}
@@ -1,5 +1,10 @@
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
 
+#include "history_ring.hxx"
 #include "sysmon.hxx"
 
 using namespace std::chrono_literals;
@@ -15,25 +20,38 @@ sysmon_error::sysmon_error(const std::string& message)
 /// \brief Карта регистров юнита.
 ///
 ///
-struct reg_offset {
-    inline static const std::size_t SW_RESET = 0x000, ///< Сброс.
-        SYSMON_RESET = 0x010, ///< Еще один сброс :)
-        TEMP_VALUE = 0x400, ///< Температура кристалла.
-        TEMP_MAX = 0x480, ///< Максимальная температура.
-        TEMP_MIN = 0x490, ///< Минимальная температура.
-        VCC_INT_VALUE = 0x404, ///< Напряжение питания ядра.
-        VCC_INT_MAX = 0x484, ///< Максимальное напряжение питания ядра.
-        VCC_INT_MIN = 0x494, ///< Минимальное напряжение питания ядра.
-        VCC_AUX_VALUE = 0x408, ///< Напряжение питания ПЛИС.
-        VCC_AUX_MAX = 0x488, ///< Максимальное напряжение питания ПЛИС.
-        VCC_AUX_MIN = 0x498, ///< Минимальное напряжение питания ПЛИС.
-        VREF_P_VALUE = 0x410, ///< Внешнее опорное напряжение (плюс).
-        VREF_N_VALUE = 0x414, ///< Внешнее опорное напряжение (минус).
-        VCC_BRAM_VALUE = 0x418, ///< Напряжение питания блока памяти.
-        VCC_BRAM_MAX = 0x48C, ///< Максимальное напряжение питания блока памяти.
-        VCC_BRAM_MIN = 0x49C; ///< Минимальное напряжение питания блока памяти.
+struct sysmon_regs {
+    using SW_RESET = axi_reg_default<0x000>; ///< Сброс.
+    using SYSMON_RESET = axi_reg_default<0x010>; ///< Еще один сброс :)
+    using TEMP_VALUE = axi_reg_default<0x400>; ///< Температура кристалла.
+    using TEMP_MAX = axi_reg_default<0x480>; ///< Максимальная температура.
+    using TEMP_MIN = axi_reg_default<0x490>; ///< Минимальная температура.
+    using VCC_INT_VALUE = axi_reg_default<0x404>; ///< Напряжение питания ядра.
+    using VCC_INT_MAX = axi_reg_default<0x484>; ///< Максимальное напряжение питания ядра.
+    using VCC_INT_MIN = axi_reg_default<0x494>; ///< Минимальное напряжение питания ядра.
+    using VCC_AUX_VALUE = axi_reg_default<0x408>; ///< Напряжение питания ПЛИС.
+    using VCC_AUX_MAX = axi_reg_default<0x488>; ///< Максимальное напряжение питания ПЛИС.
+    using VCC_AUX_MIN = axi_reg_default<0x498>; ///< Минимальное напряжение питания ПЛИС.
+    using VREF_P_VALUE = axi_reg_default<0x410>; ///< Внешнее опорное напряжение (плюс).
+    using VREF_N_VALUE = axi_reg_default<0x414>; ///< Внешнее опорное напряжение (минус).
+    using VCC_BRAM_VALUE = axi_reg_default<0x418>; ///< Напряжение питания блока памяти.
+    using VCC_BRAM_MAX = axi_reg_default<0x48C>; ///< Максимальное напряжение питания блока памяти.
+    using VCC_BRAM_MIN = axi_reg_default<0x49C>; ///< Минимальное напряжение питания блока памяти.
 };
 
+///
+/// \brief Все измеряемые значения: 14 регистров, читаются одним списком операций.
+///
+///
+using sysmon_telemetry = reg_map<
+    sysmon_regs::TEMP_VALUE, sysmon_regs::TEMP_MAX, sysmon_regs::TEMP_MIN,
+    sysmon_regs::VCC_INT_VALUE, sysmon_regs::VCC_INT_MAX, sysmon_regs::VCC_INT_MIN,
+    sysmon_regs::VCC_AUX_VALUE, sysmon_regs::VCC_AUX_MAX, sysmon_regs::VCC_AUX_MIN,
+    sysmon_regs::VCC_BRAM_VALUE, sysmon_regs::VCC_BRAM_MAX, sysmon_regs::VCC_BRAM_MIN,
+    sysmon_regs::VREF_P_VALUE, sysmon_regs::VREF_N_VALUE>;
+
+static_assert(sysmon_telemetry::size == 14);
+
 ///
 /// \brief Данные подсистемы системного монитора.
 ///
@@ -45,6 +63,17 @@ struct sysmon_impl::private_data {
         sysmon_convert temperature {}; ///< Параметры конвертации температуры.
         sysmon_convert voltage {}; ///< Параметры конвертации напряжения.
     } convert {}; ///< Параметры конвертации.
+    /// Чтение регистров из потока опроса и синхронные чтения не чередуются:
+    /// пакет телеметрии читается целиком, от io не требуется потокобезопасность.
+    std::mutex io_mutex {};
+    struct {
+        std::thread thread {}; ///< Поток опроса.
+        std::mutex control {}; ///< Запуск и остановка опроса.
+        std::mutex mutex {};
+        std::condition_variable wakeup {};
+        bool running {};
+        history_ring<sysmon_snapshot, 1024> history {}; ///< История снимков.
+    } sampler {}; ///< Фоновый опрос.
 };
 
 sysmon_impl::sysmon_impl(const unit_data& data, const sysmon_parser& parser)
@@ -54,16 +83,25 @@ sysmon_impl::sysmon_impl(const unit_data& data, const sysmon_parser& parser)
     d_ptr->nominals = parser.get_nominals();
     d_ptr->convert.temperature = parser.get_temperature_convert();
     d_ptr->convert.voltage = parser.get_voltage_convert();
+    if (auto period = parser.get_sample_period(); period.count()) {
+        start_sampling(period);
+    }
+}
+
+sysmon_impl::~sysmon_impl() noexcept
+{
+    stop_sampling();
 }
 
 void sysmon_impl::reset()
 {
-    reg_write(reg_offset::SW_RESET, 0x0A);
+    std::lock_guard lock { d_ptr->io_mutex };
+    reg_write(sysmon_regs::SW_RESET { 0x0A });
     std::this_thread::sleep_for(1ms);
-    reg_write(reg_offset::SW_RESET, 0x00);
+    reg_write(sysmon_regs::SW_RESET { 0x00 });
 }
 
-double sysmon_impl::convert(sysmon_convert& convert, uint32_t value) const noexcept
+double sysmon_impl::convert(const sysmon_convert& convert, uint32_t value) const noexcept
 {
     value >>= convert.justify;
     auto divider = (1 << convert.power);
@@ -76,58 +114,161 @@ sysmon_nominals sysmon_impl::get_nominals() const
     return d_ptr->nominals;
 }
 
+sysmon_value sysmon_impl::make_value(const sysmon_convert& convert,
+    uint32_t value, uint32_t max, uint32_t min) const noexcept
+{
+    sysmon_value result {};
+    result.value = this->convert(convert, value);
+    result.max = this->convert(convert, max);
+    result.min = this->convert(convert, min);
+    return result;
+}
+
+template <typename value_reg, typename max_reg, typename min_reg>
+sysmon_value sysmon_impl::read_value(const sysmon_convert& convert) const
+{
+    auto values = [this] {
+        std::lock_guard lock { d_ptr->io_mutex };
+        return reg_map_read<reg_map<value_reg, max_reg, min_reg>>();
+    }();
+    return make_value(convert, values.template get<value_reg>(), values.template get<max_reg>(), values.template get<min_reg>());
+}
+
+sysmon_snapshot sysmon_impl::read_snapshot() const
+{
+    auto values = [this] {
+        std::lock_guard lock { d_ptr->io_mutex };
+        return reg_map_read<sysmon_telemetry>();
+    }();
+    auto& temperature = d_ptr->convert.temperature;
+    auto& voltage = d_ptr->convert.voltage;
+    sysmon_snapshot snapshot {};
+    snapshot.timestamp = std::chrono::steady_clock::now();
+    snapshot.temperature = make_value(temperature, values.get<sysmon_regs::TEMP_VALUE>(),
+        values.get<sysmon_regs::TEMP_MAX>(), values.get<sysmon_regs::TEMP_MIN>());
+    snapshot.vcc_int = make_value(voltage, values.get<sysmon_regs::VCC_INT_VALUE>(),
+        values.get<sysmon_regs::VCC_INT_MAX>(), values.get<sysmon_regs::VCC_INT_MIN>());
+    snapshot.vcc_aux = make_value(voltage, values.get<sysmon_regs::VCC_AUX_VALUE>(),
+        values.get<sysmon_regs::VCC_AUX_MAX>(), values.get<sysmon_regs::VCC_AUX_MIN>());
+    snapshot.vcc_bram = make_value(voltage, values.get<sysmon_regs::VCC_BRAM_VALUE>(),
+        values.get<sysmon_regs::VCC_BRAM_MAX>(), values.get<sysmon_regs::VCC_BRAM_MIN>());
+    snapshot.vref_p = convert(voltage, values.get<sysmon_regs::VREF_P_VALUE>());
+    snapshot.vref_n = convert(voltage, values.get<sysmon_regs::VREF_N_VALUE>());
+    return snapshot;
+}
+
 sysmon_value sysmon_impl::get_temperature() const
 {
-    sysmon_value temperature {};
-    temperature.value = convert(d_ptr->convert.temperature, reg_read(reg_offset::TEMP_VALUE));
-    temperature.max = convert(d_ptr->convert.temperature, reg_read(reg_offset::TEMP_MAX));
-    temperature.min = convert(d_ptr->convert.temperature, reg_read(reg_offset::TEMP_MIN));
-    return temperature;
+    return read_value<sysmon_regs::TEMP_VALUE, sysmon_regs::TEMP_MAX, sysmon_regs::TEMP_MIN>(d_ptr->convert.temperature);
 }
 
 sysmon_value sysmon_impl::get_vcc_int() const
 {
-    sysmon_value vcc_int {};
-    vcc_int.value = convert(d_ptr->convert.voltage, reg_read(reg_offset::VCC_INT_VALUE));
-    vcc_int.max = convert(d_ptr->convert.voltage, reg_read(reg_offset::VCC_INT_MAX));
-    vcc_int.min = convert(d_ptr->convert.voltage, reg_read(reg_offset::VCC_INT_MIN));
-    return vcc_int;
+    return read_value<sysmon_regs::VCC_INT_VALUE, sysmon_regs::VCC_INT_MAX, sysmon_regs::VCC_INT_MIN>(d_ptr->convert.voltage);
 }
 
 sysmon_value sysmon_impl::get_vcc_aux() const
 {
-    sysmon_value vcc_aux {};
-    vcc_aux.value = convert(d_ptr->convert.voltage, reg_read(reg_offset::VCC_AUX_VALUE));
-    vcc_aux.max = convert(d_ptr->convert.voltage, reg_read(reg_offset::VCC_AUX_MAX));
-    vcc_aux.min = convert(d_ptr->convert.voltage, reg_read(reg_offset::VCC_AUX_MIN));
-    return vcc_aux;
+    return read_value<sysmon_regs::VCC_AUX_VALUE, sysmon_regs::VCC_AUX_MAX, sysmon_regs::VCC_AUX_MIN>(d_ptr->convert.voltage);
 }
 
 sysmon_value sysmon_impl::get_vcc_bram() const
 {
-    sysmon_value vcc_bram {};
-    vcc_bram.value = convert(d_ptr->convert.voltage, reg_read(reg_offset::VCC_BRAM_VALUE));
-    vcc_bram.max = convert(d_ptr->convert.voltage, reg_read(reg_offset::VCC_BRAM_MAX));
-    vcc_bram.min = convert(d_ptr->convert.voltage, reg_read(reg_offset::VCC_BRAM_MIN));
-    return vcc_bram;
+    return read_value<sysmon_regs::VCC_BRAM_VALUE, sysmon_regs::VCC_BRAM_MAX, sysmon_regs::VCC_BRAM_MIN>(d_ptr->convert.voltage);
 }
 
 double sysmon_impl::get_vref_p() const
 {
-    return convert(d_ptr->convert.voltage, reg_read(reg_offset::VREF_P_VALUE));
+    std::lock_guard lock { d_ptr->io_mutex };
+    return convert(d_ptr->convert.voltage, reg_read<sysmon_regs::VREF_P_VALUE>());
 }
 
 double sysmon_impl::get_vref_n() const
 {
-    return convert(d_ptr->convert.voltage, reg_read(reg_offset::VREF_N_VALUE));
+    std::lock_guard lock { d_ptr->io_mutex };
+    return convert(d_ptr->convert.voltage, reg_read<sysmon_regs::VREF_N_VALUE>());
+}
+
+void sysmon_impl::start_sampling(std::chrono::milliseconds period)
+{
+    if (period.count() <= 0) {
+        throw sysmon_error("invalid sample period");
+    }
+    auto& sampler = d_ptr->sampler;
+    std::lock_guard control { sampler.control };
+    stop_sampler();
+    std::lock_guard lock { sampler.mutex };
+    sampler.running = true;
+    sampler.thread = std::thread([this, period] {
+        auto& sampler = d_ptr->sampler;
+        auto deadline = std::chrono::steady_clock::now();
+        std::unique_lock lock { sampler.mutex };
+        while (sampler.running) {
+            lock.unlock();
+            try {
+                sampler.history.push(read_snapshot());
+            } catch (const std::exception& e) {
+                log().warn("sampling failed: {}", e.what());
+            }
+            // пропущенные из-за долгого чтения периоды не догоняются
+            deadline += period;
+            if (auto now = std::chrono::steady_clock::now(); deadline <= now) {
+                deadline += ((now - deadline) / period + 1) * period;
+            }
+            lock.lock();
+            sampler.wakeup.wait_until(lock, deadline, [&sampler] { return !sampler.running; });
+        }
+    });
+    log().debug("sampling started, period {} ms", period.count());
+}
+
+void sysmon_impl::stop_sampling() noexcept
+{
+    std::lock_guard control { d_ptr->sampler.control };
+    stop_sampler();
+}
+
+void sysmon_impl::stop_sampler() noexcept
+{
+    auto& sampler = d_ptr->sampler;
+    {
+        std::lock_guard lock { sampler.mutex };
+        if (!sampler.running) {
+            return;
+        }
+        sampler.running = false;
+    }
+    sampler.wakeup.notify_all();
+    if (sampler.thread.joinable()) {
+        sampler.thread.join();
+    }
+    log().debug("sampling stopped");
 }
 
-uint32_t sysmon_impl::reg_read(std::size_t offset) const
+bool sysmon_impl::is_sampling() const noexcept
 {
-    return io_control().reg_read(get_offset() + offset);
+    std::lock_guard lock { d_ptr->sampler.mutex };
+    return d_ptr->sampler.running;
 }
 
-void sysmon_impl::reg_write(std::size_t offset, uint32_t value) const
+bool sysmon_impl::get_snapshot(sysmon_snapshot& snapshot) const noexcept
 {
-    io_control().reg_write(get_offset() + offset, value);
+    return d_ptr->sampler.history.latest(snapshot);
+}
+
+sysmon_history sysmon_impl::get_history(std::chrono::milliseconds window) const
+{
+    auto& history = d_ptr->sampler.history;
+    auto since = std::chrono::steady_clock::now() - window;
+    auto head = history.head();
+    sysmon_history result {};
+    for (auto index = head; index && head - index < history.capacity; --index) {
+        sysmon_snapshot snapshot {};
+        if (!history.read(index - 1, snapshot) || snapshot.timestamp < since) {
+            break;
+        }
+        result.push_back(snapshot);
+    }
+    std::reverse(result.begin(), result.end());
+    return result;
 }
@@ -50,6 +50,11 @@ public:
         convert.multiplier = convert_node.get<double>("mult");
         return convert;
     }
+    auto get_sample_period() const
+    {
+        auto period = m_ptree.get_optional<std::size_t>("sample_period").get_value_or(0);
+        return std::chrono::milliseconds(period);
+    }
 };
 
 class sysmon_impl final : public sysmon_interface, public unit_base<sysmon_impl> {
@@ -62,6 +67,7 @@ public:
     inline static constexpr is_u_type type_id { is_u_type::U_THIRD_PARTY };
 
     sysmon_impl(const unit_data&, const sysmon_parser&);
+    ~sysmon_impl() noexcept;
 
 private:
     void reset() final;
@@ -72,10 +78,18 @@ private:
     sysmon_value get_vcc_bram() const final;
     double get_vref_p() const final;
     double get_vref_n() const final;
+    void start_sampling(std::chrono::milliseconds) final;
+    void stop_sampling() noexcept final;
+    bool is_sampling() const noexcept final;
+    bool get_snapshot(sysmon_snapshot&) const noexcept final;
+    sysmon_history get_history(std::chrono::milliseconds) const final;
 
-    double convert(sysmon_convert&, uint32_t) const noexcept;
-    uint32_t reg_read(std::size_t) const;
-    void reg_write(std::size_t, uint32_t) const;
+    double convert(const sysmon_convert&, uint32_t) const noexcept;
+    sysmon_value make_value(const sysmon_convert&, uint32_t, uint32_t, uint32_t) const noexcept;
+    template <typename value_reg, typename max_reg, typename min_reg>
+    sysmon_value read_value(const sysmon_convert&) const;
+    sysmon_snapshot read_snapshot() const;
+    void stop_sampler() noexcept;
 };
 
 }
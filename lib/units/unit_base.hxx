@@ -1,7 +1,9 @@
 #pragma once
 
+#include <cstdlib>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "nebulaxi/data_storage.hpp"
 #include "nebulaxi/io/io.hpp"
@@ -11,6 +13,11 @@
 #include "config_parser.hxx"
 #include "is_unit_id.hxx"
 #include "logger.hxx"
+#include "units/reg_map.hxx"
+#include "units/reg_shadow.hxx"
+#ifdef NEBULAXI_REG_STATS
+#include "units/reg_stats.hxx"
+#endif
 
 namespace insys::nebulaxi {
 
@@ -21,6 +28,7 @@ struct unit_data {
     std::size_t offset {};
     std::string name {};
     std::string info {};
+    std::vector<reg_cache_config> reg_cache {};
     unit_data(insys::nebulaxi::io io, data_storage storage, std::size_t offset, std::string name, std::string info = {})
         : io { std::move(io) }
         , storage { std::move(storage) }
@@ -35,6 +43,25 @@ template <typename unit_derrived>
 class unit_base : public virtual unit_interface {
 
     std::shared_ptr<unit_data> d_ptr {};
+    std::shared_ptr<reg_shadow> shadow_ptr { std::make_shared<reg_shadow>() };
+#ifdef NEBULAXI_REG_STATS
+    std::shared_ptr<reg_stats> stats_ptr { std::make_shared<reg_stats>() };
+#endif
+
+    uint32_t io_read(std::size_t offset) const
+    {
+#ifdef NEBULAXI_REG_STATS
+        reg_stats::scope scope { *stats_ptr, offset, reg_op::read };
+#endif
+        return d_ptr->io->reg_read(d_ptr->offset + offset);
+    }
+    void io_write(std::size_t offset, uint32_t value) const
+    {
+#ifdef NEBULAXI_REG_STATS
+        reg_stats::scope scope { *stats_ptr, offset, reg_op::write };
+#endif
+        d_ptr->io->reg_write(d_ptr->offset + offset, value);
+    }
 
 protected:
     using base = unit_base<unit_derrived>;
@@ -53,6 +80,9 @@ protected:
                 throw unit_error(error_message);
             }
         }
+        for (auto& config : d_ptr->reg_cache) {
+            shadow_ptr->declare(config);
+        }
         d_ptr->log->debug("unit created");
     }
     virtual ~unit_base() noexcept
@@ -68,6 +98,33 @@ protected:
     std::string get_type() const noexcept final { return unit_derrived::type; }
     std::string get_name() const noexcept final { return d_ptr->name; }
     std::string get_info() const noexcept final { return d_ptr->info; }
+    reg_cache_stats get_reg_cache_stats() const noexcept final { return shadow_ptr->stats(); }
+    void reg_cache_invalidate() final { shadow_ptr->invalidate(); }
+    void reg_cache_resync() final
+    {
+        shadow_ptr->resync([this](std::size_t offset) { return io_read(offset); });
+    }
+    reg_access_stats_list get_reg_access_stats() const final
+    {
+#ifdef NEBULAXI_REG_STATS
+        return stats_ptr->get();
+#else
+        return {};
+#endif
+    }
+    void reg_access_stats_reset() noexcept final
+    {
+#ifdef NEBULAXI_REG_STATS
+        stats_ptr->reset();
+#endif
+    }
+    ///
+    /// \brief Объявление политики кэширования регистра в карте регистров юнита.
+    ///
+    void reg_cache_declare(std::size_t offset, reg_cache_policy policy, uint32_t reset_value = {}) const
+    {
+        shadow_ptr->declare({ offset, policy, reset_value });
+    }
 
     template <typename axi_reg_type>
     axi_reg_type reg_read() const
@@ -81,11 +138,60 @@ protected:
     }
     uint32_t reg_read(std::size_t offset) const
     {
-        return io_control().reg_read(get_offset() + offset);
+        if (!shadow_ptr->enabled()) {
+            return io_read(offset);
+        }
+        uint32_t value {};
+        std::size_t generation {};
+        if (!shadow_ptr->read(offset, value, generation)) {
+            value = io_read(offset);
+            shadow_ptr->fill(offset, value, generation);
+        }
+        return value;
     }
     void reg_write(std::size_t offset, uint32_t value) const
     {
-        io_control().reg_write(get_offset() + offset, value);
+        io_write(offset, value);
+        if (shadow_ptr->enabled()) {
+            shadow_ptr->update(offset, value);
+        }
+    }
+
+    ///
+    /// \brief Пакетный доступ к регистрам юнита.
+    /// \details Смещения задаются относительно юнита, операции выполняются в порядке следования.
+    /// У io_interface нет пакетного доступа, поэтому каждая операция - отдельное обращение к io.
+    ///
+    /// \param[in,out] batch Список операций, для чтения заполняется поле value.
+    ///
+    template <typename batch_type>
+    void reg_batch_submit(batch_type& batch) const
+    {
+        for (auto& transfer : batch) {
+            if (transfer.op == reg_op::write) {
+                reg_write(transfer.offset, transfer.value);
+            } else {
+                transfer.value = reg_read(transfer.offset);
+            }
+        }
+    }
+    template <typename batch_type>
+    void reg_read_batch(batch_type& batch) const
+    {
+        for (auto& transfer : batch) {
+            transfer.op = reg_op::read;
+        }
+        reg_batch_submit(batch);
+    }
+    ///
+    /// \brief Запись списка регистров по порядку, поле op не учитывается.
+    ///
+    template <typename batch_type>
+    void reg_write_batch(const batch_type& batch) const
+    {
+        for (auto& transfer : batch) {
+            reg_write(transfer.offset, transfer.value);
+        }
     }
 
     template <typename axi_field_type>
@@ -99,6 +205,45 @@ protected:
         auto reg_value = axi_field_type { reg_read(axi_field_type::offset) };
         reg_write(axi_field_type::offset, reg_value.set_field(value));
     }
+    template <typename... axi_field_types>
+    void fields_write(reg_field_value<axi_field_types>... values) const
+    {
+        insys::nebulaxi::reg_fields_write<axi_field_types...>(
+            [this](std::size_t offset) { return reg_read(offset); },
+            [this](std::size_t offset, uint32_t value) { reg_write(offset, value); },
+            values...);
+    }
+    template <typename... axi_field_types>
+    auto fields_read() const
+    {
+        return insys::nebulaxi::reg_fields_read<axi_field_types...>([this](std::size_t offset) { return reg_read(offset); });
+    }
+
+    ///
+    /// \brief Чтение группы регистров одним списком операций.
+    ///
+    /// \tparam map_type карта регистров (reg_map).
+    ///
+    template <typename map_type>
+    auto reg_map_read() const
+    {
+        auto batch = reg_map_values<map_type>::read_batch();
+        reg_read_batch(batch);
+        reg_map_values<map_type> values {};
+        values.load(batch);
+        return values;
+    }
+    ///
+    /// \brief Запись измененных регистров группы одним списком операций.
+    /// \details Регистры, биты которых заданы не полностью, предварительно читаются.
+    ///
+    template <typename map_type>
+    void reg_map_write(const reg_map_values<map_type>& values) const
+    {
+        auto read = values.modify_batch();
+        reg_read_batch(read);
+        reg_write_batch(values.write_batch(read));
+    }
 
 public:
     static bool is_same_type(const std::string& type) noexcept
@@ -154,6 +299,20 @@ public:
     {
         return m_ptree.get_child_optional("chips");
     }
+    auto get_reg_cache() const
+    {
+        std::vector<reg_cache_config> reg_cache {};
+        if (auto registers = m_ptree.get_child_optional("registers"); registers.has_value()) {
+            for (auto& [str, reg_node] : registers.value()) {
+                reg_cache_config config {};
+                config.offset = std::strtoul(reg_node.get<std::string>("offset").c_str(), nullptr, 16);
+                config.policy = reg_cache_policy_from_string(reg_node.get<std::string>("policy"));
+                config.reset_value = std::strtoul(reg_node.get<std::string>("reset", "0").c_str(), nullptr, 16);
+                reg_cache.push_back(config);
+            }
+        }
+        return reg_cache;
+    }
 };
 
 }
@@ -36,6 +36,7 @@ units_builder::build(const config_tree& units_tree)
         data.offset = parser.get_offset();
         data.name = parser.get_name();
         data.info = parser.get_info();
+        data.reg_cache = parser.get_reg_cache();
         if (reg_impl::is_same_type(type)) {
             auto unit = add_unit<reg_impl>(data);
             if (auto chips_tree = parser.get_chips_optional(); chips_tree.has_value()) {